@@ -0,0 +1,247 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_AOSOAVECTOR_H__
+#define __CONTAINERS_AOSOAVECTOR_H__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SoAVector.h"
+#include "tools/AlignedAllocator.h"
+
+namespace containers
+{
+    // Size of the SIMD registers of the target
+#if defined( __AVX512F__ )
+    static constexpr const std::size_t  SimdRegisterSize = 64;
+#elif defined( __AVX__ )
+    static constexpr const std::size_t  SimdRegisterSize = 32;
+#else
+    static constexpr const std::size_t  SimdRegisterSize = 16; // SSE2 / NEON
+#endif
+
+    // Number of T in a SIMD register
+    template < typename T >
+    constexpr std::size_t   SimdWidth = sizeof( T ) < SimdRegisterSize ? SimdRegisterSize / sizeof( T ) : 1;
+
+    // Vector of tuples stored as an Array-Of-Structures-Of-Arrays: blocks of W elements, each field contiguous inside its block
+    // - a block holds one array of W values per field (the order of the arrays in the block is the member order of std::tuple, reversed
+    //   on libstdc++): with W = SimdWidth< field >, a vectorized kernel loads a field of W elements at once (block< I >( b )), as with a SoAVector
+    // - the fields of an element stay within the block (W * sizeof( element ) bytes), a random access touches as many cache lines as an AoS
+    //   when the block is not larger than a cache line, where a SoA touches one line per field (see CacheTestSuite CompactRandomAccessAOSvsSOABenchmark)
+    // soa[ i ] is a proxy on the fields of the element i (see SoAReference)
+    // The lanes of the last block past size() hold value initialized fields: a kernel can process whole blocks and ignore those lanes
+    // When the fields have the same size, each field block is aligned on W * sizeof( field ) (aligned SIMD loads)
+    template < std::size_t W, typename... Fields >
+    class AoSoAVector
+    {
+        static_assert( sizeof...( Fields ) > 0, "AoSoAVector without field" );
+        static_assert( W > 0 && ( W & ( W - 1 ) ) == 0, "The block size must be a power of 2" );
+
+    public:
+        using value_type = std::tuple< Fields... >;
+        using reference = SoAReference< false, Fields... >;
+        using const_reference = SoAReference< true, Fields... >;
+        using iterator = details::ProxyIterator< AoSoAVector, reference >;
+        using const_iterator = details::ProxyIterator< const AoSoAVector, const_reference >;
+
+        template < std::size_t I >
+        using field_type = std::tuple_element_t< I, value_type >;
+
+        template < std::size_t I >
+        using field_block = std::array< field_type< I >, W >;
+
+        static constexpr const std::size_t  FieldCount = sizeof...( Fields );
+        static constexpr const std::size_t  BlockSize = W;
+
+        AoSoAVector()
+            : size_( 0 )
+        {
+            // NOTHING
+        }
+
+        // count value initialized elements
+        explicit AoSoAVector( std::size_t count )
+            : AoSoAVector()
+        {
+            resize( count );
+        }
+
+        std::size_t     size() const { return size_; }
+        bool            empty() const { return size_ == 0; }
+        std::size_t     capacity() const { return blocks_.capacity() * W; }
+
+        // Blocks of W elements, the last one may be partial
+        std::size_t     blockCount() const { return blocks_.size(); }
+        std::size_t     blockSize( std::size_t block ) const { return block + 1 < blocks_.size() ? W : size_ - block * W; }
+
+        // The W values of the field I in the block, invalidated by the reallocations
+        template < std::size_t I >
+        field_block< I >&           block( std::size_t block ) { return std::get< I >( blocks_[ block ].fields ); }
+
+        template < std::size_t I >
+        const field_block< I >&     block( std::size_t block ) const { return std::get< I >( blocks_[ block ].fields ); }
+
+        reference           operator[]( std::size_t i ) { return makeReference< reference >( *this, i, Indexes() ); }
+        const_reference     operator[]( std::size_t i ) const { return makeReference< const_reference >( *this, i, Indexes() ); }
+
+        reference           at( std::size_t i ) { return operator[]( checkIndex( i ) ); }
+        const_reference     at( std::size_t i ) const { return operator[]( checkIndex( i ) ); }
+
+        reference           front() { return operator[]( 0 ); }
+        const_reference     front() const { return operator[]( 0 ); }
+        reference           back() { return operator[]( size_ - 1 ); }
+        const_reference     back() const { return operator[]( size_ - 1 ); }
+
+        iterator        begin() { return iterator( *this, 0 ); }
+        iterator        end() { return iterator( *this, size_ ); }
+        const_iterator  begin() const { return const_iterator( *this, 0 ); }
+        const_iterator  end() const { return const_iterator( *this, size_ ); }
+        const_iterator  cbegin() const { return begin(); }
+        const_iterator  cend() const { return end(); }
+
+        // One value per field
+        template < typename... Args >
+        reference   emplace_back( Args&&... args )
+        {
+            static_assert( sizeof...( Args ) == FieldCount, "One value per field is expected" );
+
+            if ( size_ % W != 0 )
+                return assignBack( std::forward< Args >( args )... );
+
+            // args may be fields of an element (emplace_back( aosoa.front().get< 0 >(), ... )): they are read before the blocks may be reallocated
+            value_type value( std::forward< Args >( args )... );
+            blocks_.emplace_back();
+            return std::apply( [ this ] ( auto&... fields ) { return assignBack( std::move( fields )... ); }, value );
+        }
+
+        void    push_back( const value_type& value ) { std::apply( [ this ] ( const auto&... fields ) { emplace_back( fields... ); }, value ); }
+        void    push_back( value_type&& value ) { std::apply( [ this ] ( auto&&... fields ) { emplace_back( std::move( fields )... ); }, value ); }
+
+        void    pop_back()
+        {
+            resize( size_ - 1 );
+        }
+
+        // Keep the order of the elements (the following elements are moved back, field by field)
+        iterator    erase( const_iterator first, const_iterator last )
+        {
+            const auto count = last.index() - first.index();
+            if ( count == 0 )
+                return iterator( *this, first.index() );
+
+            for ( auto i = first.index(); i + count < size_; ++i )
+                moveFields( i + count, i, Indexes() );
+            resize( size_ - count );
+            return iterator( *this, first.index() );
+        }
+
+        iterator    erase( const_iterator position ) { return erase( position, position + 1 ); }
+
+        void    reserve( std::size_t count )
+        {
+            blocks_.reserve( ( count + W - 1 ) / W );
+        }
+
+        void    resize( std::size_t count )
+        {
+            const auto blockCount = ( count + W - 1 ) / W;
+            for ( auto i = count; i < std::min( size_, blockCount * W ); ++i )
+                resetFields( i, Indexes() ); // the lanes of the last block kept
+            blocks_.resize( blockCount );
+            size_ = count;
+        }
+
+        void    clear()
+        {
+            blocks_.clear();
+            size_ = 0;
+        }
+
+        void    swap( AoSoAVector& other ) noexcept
+        {
+            blocks_.swap( other.blocks_ );
+            std::swap( size_, other.size_ );
+        }
+
+    private:
+        using Indexes = std::index_sequence_for< Fields... >;
+
+        // value initialized by the vector
+        struct Block
+        {
+            std::tuple< std::array< Fields, W >... >    fields;
+        };
+
+        template < std::size_t I >
+        field_type< I >&    fieldAt( std::size_t i ) { return std::get< I >( blocks_[ i / W ].fields )[ i % W ]; }
+
+        template < typename Reference, typename Self, std::size_t... Is >
+        static Reference    makeReference( Self& self, std::size_t i, std::index_sequence< Is... > )
+        {
+            auto& block = self.blocks_[ i / W ];
+            return Reference( std::make_tuple( std::get< Is >( block.fields ).data() + i % W... ) );
+        }
+
+        // The block of the element size_ is allocated
+        template < typename... Args >
+        reference   assignBack( Args&&... args )
+        {
+            try
+            {
+                assignFields( size_, Indexes(), std::forward< Args >( args )... );
+            }
+            catch ( ... )
+            {
+                resetFields( size_, Indexes() ); // the lanes past size() stay value initialized
+                if ( size_ % W == 0 )
+                    blocks_.pop_back();
+                throw;
+            }
+            return operator[]( size_++ );
+        }
+
+        template < std::size_t... Is, typename... Args >
+        void    assignFields( std::size_t i, std::index_sequence< Is... >, Args&&... args )
+        {
+            ( ( fieldAt< Is >( i ) = std::forward< Args >( args ) ), ... );
+        }
+
+        template < std::size_t... Is >
+        void    moveFields( std::size_t from, std::size_t to, std::index_sequence< Is... > )
+        {
+            ( ( fieldAt< Is >( to ) = std::move( fieldAt< Is >( from ) ) ), ... );
+        }
+
+        template < std::size_t... Is >
+        void    resetFields( std::size_t i, std::index_sequence< Is... > )
+        {
+            ( ( fieldAt< Is >( i ) = field_type< Is >() ), ... );
+        }
+
+        std::size_t     checkIndex( std::size_t i ) const
+        {
+            if ( i < size_ )
+                return i;
+
+            std::ostringstream ss;
+            ss << "AoSoAVector index " << i << " is out of range (size " << size_ << ")";
+            throw std::out_of_range( ss.str() );
+        }
+
+    private:
+        std::vector< Block, tools::AlignedAllocator< Block > >  blocks_;
+        std::size_t                                             size_;
+    };
+}
+
+#endif /* ! __CONTAINERS_AOSOAVECTOR_H__ */
@@ -0,0 +1,219 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_BOUNDEDQUEUEMPMC_H__
+#define __CONTAINERS_BOUNDEDQUEUEMPMC_H__
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "tools/CacheInformation.h"
+
+namespace containers
+{
+    // Bounded Multiple Producer Multiple Consumer queue (based on Dmitry Vyukov bounded MPMC queue), no allocation after construction
+    // Each cell holds a sequence number telling who owns it:
+    //   - sequence == position         : free, a producer can claim it by CAS on enqueuePos_
+    //   - sequence == position + 1     : full, a consumer can claim it by CAS on dequeuePos_
+    //   - sequence == position + size  : the consumer released it for the producer of the next lap
+    // Producers only contend on enqueuePos_, consumers on dequeuePos_ (each on their own cache line), and a producer never waits on a consumer which is not done with its cell
+    // A claimed cell is always published, even on exception (otherwise every later producer / consumer of the cell would spin forever):
+    //   - the construction throws: the cell is published as skipped, the consumers step over it
+    //   - the move assignment of try_pop throws: the element is dropped (destroyed) and the cell released before the exception propagates
+    // Blocking / timed operations spin on the try version then yield (no kernel object), use it when producers / consumers are mostly busy
+    template < typename T >
+    class BoundedQueueMPMC
+    {
+    public:
+        using value_type = T;
+
+        // capacity is rounded up to the next power of two
+        explicit BoundedQueueMPMC( std::size_t capacity )
+            : mask_( roundUpToPowerOfTwo( capacity < 2 ? 2 : capacity ) - 1 )
+            , cells_( new Cell[ mask_ + 1 ] )
+            , enqueuePos_( 0 )
+            , dequeuePos_( 0 )
+        {
+            for ( std::size_t i = 0; i <= mask_; ++i )
+                cells_[ i ].sequence.store( i, std::memory_order_relaxed );
+        }
+
+        BoundedQueueMPMC( const BoundedQueueMPMC& ) = delete;
+        BoundedQueueMPMC& operator=( const BoundedQueueMPMC& ) = delete;
+
+        ~BoundedQueueMPMC()
+        {
+            for ( auto pos = dequeuePos_.load( std::memory_order_relaxed ), end = enqueuePos_.load( std::memory_order_relaxed ); pos != end; ++pos )
+                if ( ! cells_[ pos & mask_ ].isSkipped )
+                    std::launder( reinterpret_cast< T* >( &cells_[ pos & mask_ ].storage ) )->~T();
+        }
+
+        template < typename... Args >
+        bool    try_emplace( Args&&... args )
+        {
+            auto pos = enqueuePos_.load( std::memory_order_relaxed );
+            for ( ;; )
+            {
+                auto& cell = cells_[ pos & mask_ ];
+                auto sequence = cell.sequence.load( std::memory_order_acquire );
+                auto diff = static_cast< std::ptrdiff_t >( sequence ) - static_cast< std::ptrdiff_t >( pos );
+                if ( diff == 0 )
+                {
+                    if ( enqueuePos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                    {
+                        try
+                        {
+                            new ( &cell.storage ) T( std::forward< Args >( args )... );
+                        }
+                        catch ( ... )
+                        {
+                            cell.isSkipped = true;
+                            cell.sequence.store( pos + 1, std::memory_order_release );
+                            throw;
+                        }
+                        cell.sequence.store( pos + 1, std::memory_order_release );
+                        return true;
+                    }
+                }
+                else if ( diff < 0 ) // the consumer of the previous lap is not done: full
+                    return false;
+                else // another producer claimed the cell
+                    pos = enqueuePos_.load( std::memory_order_relaxed );
+            }
+        }
+
+        bool    try_push( const T& value ) { return try_emplace( value ); }
+        bool    try_push( T&& value ) { return try_emplace( std::move( value ) ); }
+
+        bool    try_pop( T& value )
+        {
+            auto pos = dequeuePos_.load( std::memory_order_relaxed );
+            for ( ;; )
+            {
+                auto& cell = cells_[ pos & mask_ ];
+                auto sequence = cell.sequence.load( std::memory_order_acquire );
+                auto diff = static_cast< std::ptrdiff_t >( sequence ) - static_cast< std::ptrdiff_t >( pos + 1 );
+                if ( diff == 0 )
+                {
+                    if ( dequeuePos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                    {
+                        if ( cell.isSkipped )
+                        {
+                            cell.isSkipped = false;
+                            cell.sequence.store( pos + mask_ + 1, std::memory_order_release );
+                            pos = dequeuePos_.load( std::memory_order_relaxed );
+                            continue;
+                        }
+
+                        auto& e = *std::launder( reinterpret_cast< T* >( &cell.storage ) );
+                        try
+                        {
+                            value = std::move( e );
+                        }
+                        catch ( ... )
+                        {
+                            e.~T();
+                            cell.sequence.store( pos + mask_ + 1, std::memory_order_release );
+                            throw;
+                        }
+                        e.~T();
+                        cell.sequence.store( pos + mask_ + 1, std::memory_order_release );
+                        return true;
+                    }
+                }
+                else if ( diff < 0 ) // the producer of this lap is not done: empty
+                    return false;
+                else
+                    pos = dequeuePos_.load( std::memory_order_relaxed );
+            }
+        }
+
+        void    push( T value )
+        {
+            spinUntil( [ & ] { return try_push( std::move( value ) ); } );
+        }
+
+        void    pop( T& value )
+        {
+            spinUntil( [ & ] { return try_pop( value ); } );
+        }
+
+        template < typename Rep, typename Period >
+        bool    try_push_for( T value, const std::chrono::duration< Rep, Period >& timeout )
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            return spinUntil( [ & ] { return try_push( std::move( value ) ); }, [ &deadline ] { return std::chrono::steady_clock::now() >= deadline; } );
+        }
+
+        template < typename Rep, typename Period >
+        bool    try_pop_for( T& value, const std::chrono::duration< Rep, Period >& timeout )
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            return spinUntil( [ & ] { return try_pop( value ); }, [ &deadline ] { return std::chrono::steady_clock::now() >= deadline; } );
+        }
+
+        // Approximation if called while other threads are running (the skipped cells not stepped over yet are counted)
+        std::size_t     size() const
+        {
+            auto enqueuePos = enqueuePos_.load( std::memory_order_acquire );
+            auto dequeuePos = dequeuePos_.load( std::memory_order_acquire );
+            return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+        }
+
+        bool            empty() const { return size() == 0; }
+        std::size_t     capacity() const { return mask_ + 1; }
+
+    private:
+        struct Cell
+        {
+            std::atomic< std::size_t >                              sequence;
+            std::aligned_storage_t< sizeof( T ), alignof( T ) >     storage;
+            bool                                                    isSkipped = false; // published by sequence, as storage
+        };
+
+        static std::size_t  roundUpToPowerOfTwo( std::size_t n )
+        {
+            std::size_t result = 1;
+            while ( result < n )
+                result <<= 1;
+            return result;
+        }
+
+        template < typename F, typename IsTimeout >
+        static bool     spinUntil( F&& f, IsTimeout&& isTimeout )
+        {
+            for ( auto spin = 0; ! f(); ++spin )
+            {
+                if ( spin < 64 )
+                    continue;
+
+                if ( isTimeout() )
+                    return false;
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        template < typename F >
+        static void     spinUntil( F&& f )
+        {
+            spinUntil( std::forward< F >( f ), [] { return false; } );
+        }
+
+    private:
+        // read only after construction
+        alignas( tools::CacheLineSize ) const std::size_t                mask_;
+        const std::unique_ptr< Cell[] >                                   cells_;
+
+        alignas( tools::CacheLineSize ) std::atomic< std::size_t >       enqueuePos_;
+        alignas( tools::CacheLineSize ) std::atomic< std::size_t >       dequeuePos_;
+    };
+}
+
+#endif /* ! __CONTAINERS_BOUNDEDQUEUEMPMC_H__ */
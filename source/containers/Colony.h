@@ -0,0 +1,211 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_COLONY_H__
+#define __CONTAINERS_COLONY_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "generic/Bits.h"
+#include "tools/CacheInformation.h"
+
+namespace containers
+{
+    static constexpr const std::size_t  ColonyBlockSize = 64; // one occupancy word
+
+    // Position of an element in a Colony plus the generation of its slot when it was inserted (as SlotMapHandle)
+    // Once the element is erased the handle is stale: get / erase reject it, even when the slot holds another element since
+    struct ColonyHandle
+    {
+        std::uint32_t   block;
+        std::uint32_t   slot;
+        std::uint32_t   generation;
+
+        bool    operator==( const ColonyHandle& other ) const { return block == other.block && slot == other.slot && generation == other.generation; }
+        bool    operator!=( const ColonyHandle& other ) const { return ! ( *this == other ); }
+    };
+
+    // Unordered bag of elements which never move (colony / hive, similar to plf::colony / std::hive)
+    // - the elements are in blocks of BlockSize slots, allocated once and never reallocated: pointers and handles stay valid until erase
+    // - the skip-field is the occupancy bitmap of each block (one word): the iteration jumps from element to element with tzcnt,
+    //   the elements of a block being contiguous the iteration stays mostly contiguous even with holes
+    // - the blocks which have a free slot are kept in a stack: insert fills the lowest free slot of the last block freed, so erased slots are reused
+    // - each slot has a generation, bumped when its element is erased, so a stale handle is not taken for the element reusing the slot
+    // The storage of a block is aligned on a cache line and spans whole cache lines (64 elements), blocks can be processed concurrently without false sharing
+    template < typename T >
+    class Colony
+    {
+    public:
+        using value_type = T;
+        using handle_type = ColonyHandle;
+
+        static constexpr const std::size_t  BlockSize = ColonyBlockSize;
+
+        Colony()
+            : size_( 0 )
+        {
+            // NOTHING
+        }
+
+        Colony( const Colony& ) = delete;
+        Colony& operator=( const Colony& ) = delete;
+
+        Colony( Colony&& other ) noexcept
+            : blocks_( std::move( other.blocks_ ) )
+            , blocksWithFreeSlot_( std::move( other.blocksWithFreeSlot_ ) )
+            , size_( std::exchange( other.size_, 0 ) )
+        {
+            // NOTHING
+        }
+
+        ~Colony()
+        {
+            clear();
+        }
+
+        template < typename... Args >
+        ColonyHandle    emplace( Args&&... args )
+        {
+            if ( blocksWithFreeSlot_.empty() )
+            {
+                blocks_.push_back( std::make_unique< Block >() );
+                blocksWithFreeSlot_.push_back( static_cast< std::uint32_t >( blocks_.size() - 1 ) );
+            }
+
+            const auto blockIndex = blocksWithFreeSlot_.back();
+            auto& block = *blocks_[ blockIndex ];
+            const auto slot = generics::countTrailingZeros( ~block.occupancy );
+            ::new ( static_cast< void* >( block.element( slot ) ) ) T( std::forward< Args >( args )... );
+
+            block.occupancy |= std::uint64_t( 1 ) << slot;
+            if ( block.occupancy == FullBlock )
+                blocksWithFreeSlot_.pop_back();
+            ++size_;
+            return ColonyHandle{ blockIndex, slot, block.generations[ slot ] };
+        }
+
+        ColonyHandle    insert( const T& value ) { return emplace( value ); }
+        ColonyHandle    insert( T&& value ) { return emplace( std::move( value ) ); }
+
+        // false if there is no element at handle
+        bool    erase( ColonyHandle handle )
+        {
+            if ( get( handle ) == nullptr )
+                return false;
+
+            auto& block = *blocks_[ handle.block ];
+            if ( block.occupancy == FullBlock )
+                blocksWithFreeSlot_.push_back( handle.block );
+
+            block.element( handle.slot )->~T();
+            block.occupancy &= ~( std::uint64_t( 1 ) << handle.slot );
+            ++block.generations[ handle.slot ];
+            --size_;
+            return true;
+        }
+
+        // nullptr if there is no element at handle (erased, even if the slot was reused since)
+        T*          get( ColonyHandle handle ) { return const_cast< T* >( static_cast< const Colony& >( *this ).get( handle ) ); }
+        const T*    get( ColonyHandle handle ) const
+        {
+            if ( handle.block >= blocks_.size() || handle.slot >= BlockSize )
+                return nullptr;
+
+            const auto& block = *blocks_[ handle.block ];
+            return ( block.occupancy >> handle.slot ) & 1 && block.generations[ handle.slot ] == handle.generation ? block.element( handle.slot ) : nullptr;
+        }
+
+        // handle must be valid (not checked)
+        T&          operator[]( ColonyHandle handle ) { return *blocks_[ handle.block ]->element( handle.slot ); }
+        const T&    operator[]( ColonyHandle handle ) const { return *blocks_[ handle.block ]->element( handle.slot ); }
+
+        // f( T& ) on each element, in memory order
+        template < typename F >
+        void    for_each( F&& f ) { for_each_in_blocks( 0, blocks_.size(), f ); }
+
+        template < typename F >
+        void    for_each( F&& f ) const { for_each_in_blocks( 0, blocks_.size(), f ); }
+
+        // f( T& ) on each element of the blocks [ first, last [
+        template < typename F >
+        void    for_each_in_blocks( std::size_t first, std::size_t last, F&& f )
+        {
+            for ( ; first < last; ++first )
+            {
+                auto& block = *blocks_[ first ];
+                if ( block.occupancy == FullBlock ) // contiguous
+                    for ( auto it = block.element( 0 ), it_end = it + BlockSize; it != it_end; ++it )
+                        f( *it );
+                else
+                    for ( auto bits = block.occupancy; bits != 0; bits &= bits - 1 )
+                        f( *block.element( generics::countTrailingZeros( bits ) ) );
+            }
+        }
+
+        template < typename F >
+        void    for_each_in_blocks( std::size_t first, std::size_t last, F&& f ) const
+        {
+            for ( ; first < last; ++first )
+            {
+                const auto& block = *blocks_[ first ];
+                if ( block.occupancy == FullBlock ) // contiguous
+                    for ( auto it = block.element( 0 ), it_end = it + BlockSize; it != it_end; ++it )
+                        f( *it );
+                else
+                    for ( auto bits = block.occupancy; bits != 0; bits &= bits - 1 )
+                        f( *block.element( generics::countTrailingZeros( bits ) ) );
+            }
+        }
+
+        // Raw access to the blocks, for the type erased users (the element of slot i is at element( block, 0 ) + i)
+        std::size_t     blockCount() const { return blocks_.size(); }
+        std::uint64_t   occupancy( std::size_t block ) const { return blocks_[ block ]->occupancy; }
+        T*              element( std::size_t block, unsigned slot ) { return blocks_[ block ]->element( slot ); }
+        const T*        element( std::size_t block, unsigned slot ) const { return blocks_[ block ]->element( slot ); }
+
+        std::size_t     size() const { return size_; }
+        bool            empty() const { return size_ == 0; }
+
+        // The blocks are kept for reuse
+        void    clear()
+        {
+            for_each( [] ( T& x ) { x.~T(); } );
+            blocksWithFreeSlot_.clear();
+            for ( auto i = blocks_.size(); i-- > 0; )
+            {
+                auto& block = *blocks_[ i ];
+                for ( auto bits = block.occupancy; bits != 0; bits &= bits - 1 )
+                    ++block.generations[ generics::countTrailingZeros( bits ) ];
+                block.occupancy = 0;
+                blocksWithFreeSlot_.push_back( static_cast< std::uint32_t >( i ) ); // block 0 on top
+            }
+            size_ = 0;
+        }
+
+    private:
+        static constexpr const std::uint64_t    FullBlock = ~std::uint64_t( 0 );
+
+        struct Block
+        {
+            T*          element( unsigned slot ) { return reinterpret_cast< T* >( storage ) + slot; }
+            const T*    element( unsigned slot ) const { return reinterpret_cast< const T* >( storage ) + slot; }
+
+            alignas( alignof( T ) > tools::CacheLineSize ? alignof( T ) : tools::CacheLineSize ) unsigned char storage[ BlockSize * sizeof( T ) ];
+            std::uint64_t   occupancy = 0;
+            std::array< std::uint32_t, BlockSize >  generations {};
+        };
+
+        std::vector< std::unique_ptr< Block > >     blocks_;
+        std::vector< std::uint32_t >                blocksWithFreeSlot_;
+        std::size_t                                 size_;
+    };
+}
+
+#endif /* ! __CONTAINERS_COLONY_H__ */
@@ -0,0 +1,353 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_CONCURRENTHASHMAP_H__
+#define __CONTAINERS_CONCURRENTHASHMAP_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "FlatHashMap.h"
+#include "generic/FastHash.h"
+#include "generic/HashCombine.h"
+#include "threading/EpochReclamation.h"
+#include "tools/CacheInformation.h"
+
+namespace containers
+{
+    // Hash map shared by several threads, reads without lock (replace a std::unordered_map behind a shared_mutex, every reader of which
+    // writes the reader count of the mutex: the readers of different keys contend on that cache line, see ThreadingTestSuite ConcurrentHashMapBenchmark)
+    // - the map is split in segments (chosen by the high bits of the hash), each an open addressing table (linear probing, tombstones) with its own mutex:
+    //   the writers of different segments do not contend
+    // - each slot holds a version (seqlock): a writer marks the slot busy, writes it then bumps the version. A reader reads the key and the value
+    //   then checks that the version did not change, and retries the slot otherwise. A reader never writes shared memory
+    // - a segment grows on its own (doubles, or rehashes in place when it is mostly tombstones) under its mutex: only the writers of that segment wait
+    //   for the rehash, the readers keep using the previous table until the new one is published. The previous table is then retired to Reclamation
+    //   (threading::EpochReclamation or threading::HazardPointers), a reader pinning it while it is reclaimed
+    // Key and Value must be trivially copyable (a reader may copy a slot being written, then drop the copy), the reads are lock-free when
+    // std::atomic< Key > and std::atomic< Value > are
+    // The values are returned by copy, there is no iterator nor reference
+    template < typename Key, typename Value, typename Hash = generics::FastHash, typename KeyEqual = std::equal_to< Key >, typename Reclamation = threading::EpochReclamation >
+    class ConcurrentHashMap
+    {
+        static_assert( std::is_trivially_copyable< Key >::value && std::is_trivially_copyable< Value >::value, "ConcurrentHashMap key and value must be trivially copyable" );
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+
+        static constexpr const std::size_t  DefaultSegmentCount = 64;
+
+        // segmentCount (rounded up to a power of 2) bounds the number of writers running at once, capacity is the number of elements expected
+        explicit ConcurrentHashMap( std::size_t capacity = 0, std::size_t segmentCount = DefaultSegmentCount, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual() )
+            : segmentCount_( roundUpToPowerOfTwo( segmentCount < 1 ? 1 : ( segmentCount > MaxSegmentCount ? MaxSegmentCount : segmentCount ) ) )
+            , segments_( new Segment[ segmentCount_ ] )
+            , hash_( hash )
+            , equal_( equal )
+        {
+            const auto segmentCapacity = capacityFor( ( capacity + segmentCount_ - 1 ) / segmentCount_ );
+            for ( std::size_t i = 0; i < segmentCount_; ++i )
+                segments_[ i ].table.store( new Table( segmentCapacity ), std::memory_order_relaxed );
+        }
+
+        ConcurrentHashMap( const ConcurrentHashMap& ) = delete;
+        ConcurrentHashMap& operator=( const ConcurrentHashMap& ) = delete;
+
+        // No other thread can access the map anymore (the tables retired before are owned by Reclamation)
+        ~ConcurrentHashMap()
+        {
+            for ( std::size_t i = 0; i < segmentCount_; ++i )
+                delete segments_[ i ].table.load( std::memory_order_relaxed );
+        }
+
+        // Copy the value of key into value, return false if the key is not in the map
+        bool    find( const Key& key, Value& value ) const
+        {
+            const auto hash = hashOf( key );
+            typename Reclamation::Guard guard;
+            const auto table = guard.protect( segmentOf( hash ).table );
+
+            for ( auto index = hash & table->mask; ; index = ( index + 1 ) & table->mask )
+            {
+                const auto& slot = table->slots[ index ];
+                for ( ;; )
+                {
+                    const auto control = slot.control.load( std::memory_order_acquire );
+                    const auto state = stateOf( control );
+                    if ( state == Busy )
+                    {
+                        std::this_thread::yield(); // a writer is in the middle of the slot
+                        continue;
+                    }
+                    if ( state == Empty )
+                        return false;
+                    if ( state == Deleted )
+                        break;
+
+                    const auto slotKey = slot.key.load( std::memory_order_relaxed );
+                    const auto slotValue = slot.value.load( std::memory_order_relaxed );
+                    std::atomic_thread_fence( std::memory_order_acquire ); // the key and the value are read before the version is checked again
+                    if ( slot.control.load( std::memory_order_relaxed ) != control )
+                        continue;
+
+                    if ( ! equal_( slotKey, key ) )
+                        break;
+
+                    value = slotValue;
+                    return true;
+                }
+            }
+        }
+
+        bool    contains( const Key& key ) const
+        {
+            Value value;
+            return find( key, value );
+        }
+
+        // Return false (and leave the map unchanged) if key is already in the map
+        bool    insert( const Key& key, const Value& value ) { return write( key, value, false ); }
+
+        // Return true if key was inserted, false if its value was replaced
+        bool    insert_or_assign( const Key& key, const Value& value ) { return write( key, value, true ); }
+
+        // Return false if the key is not in the map
+        bool    erase( const Key& key )
+        {
+            const auto hash = hashOf( key );
+            auto& segment = segmentOf( hash );
+            std::lock_guard< std::mutex > lock( segment.mutex );
+
+            auto table = segment.table.load( std::memory_order_relaxed );
+            const auto index = findIndex( *table, key, hash );
+            if ( index == NotFound )
+                return false;
+
+            auto& slot = table->slots[ index ];
+            publish( slot, Deleted );
+            segment.size.store( segment.size.load( std::memory_order_relaxed ) - 1, std::memory_order_relaxed );
+            ++segment.deleted;
+            return true;
+        }
+
+        // Approximation if called while other threads are writing
+        std::size_t     size() const
+        {
+            std::size_t result = 0;
+            for ( std::size_t i = 0; i < segmentCount_; ++i )
+                result += segments_[ i ].size.load( std::memory_order_relaxed );
+            return result;
+        }
+
+        bool            empty() const { return size() == 0; }
+        std::size_t     segmentCount() const { return segmentCount_; }
+
+    private:
+        static constexpr const std::size_t  NotFound = static_cast< std::size_t >( -1 );
+        static constexpr const std::size_t  MinCapacity = 8;
+        static constexpr const std::size_t  MaxSegmentCount = std::size_t( 1 ) << 16;
+
+        // control = ( version << 2 ) | state, the version is bumped by every write of the slot
+        enum State : std::uint32_t { Empty = 0, Full = 1, Deleted = 2, Busy = 3 };
+
+        static State            stateOf( std::uint32_t control ) { return static_cast< State >( control & 3 ); }
+
+        struct Slot
+        {
+            Slot()
+                : control( Empty )
+            {
+                // NOTHING
+            }
+
+            std::atomic< std::uint32_t >    control;
+            std::atomic< Key >              key;
+            std::atomic< Value >            value;
+        };
+
+        // Never modified once replaced in its segment
+        struct Table
+        {
+            explicit Table( std::size_t capacity )
+                : mask( capacity - 1 )
+                , slots( new Slot[ capacity ] )
+            {
+                // NOTHING
+            }
+
+            std::size_t                 capacity() const { return mask + 1; }
+
+            const std::size_t           mask;
+            std::unique_ptr< Slot[] >   slots;
+        };
+
+        // The writers of a segment are serialized by its mutex, size is also read by size()
+        struct alignas( tools::CacheLineSize ) Segment
+        {
+            Segment()
+                : table( nullptr )
+                , size( 0 )
+                , deleted( 0 )
+            {
+                // NOTHING
+            }
+
+            std::mutex                      mutex;
+            std::atomic< Table* >           table;
+            std::atomic< std::size_t >      size;
+            std::size_t                     deleted;
+        };
+
+        // the slots full or deleted stay below 3 / 4 of the capacity, a probe always ends on an empty slot
+        static constexpr std::size_t    maxLoad( std::size_t capacity ) { return capacity - capacity / 4; }
+
+        static constexpr std::size_t    roundUpToPowerOfTwo( std::size_t n )
+        {
+            std::size_t result = 1;
+            while ( result < n )
+                result <<= 1;
+            return result;
+        }
+
+        static std::size_t  capacityFor( std::size_t count )
+        {
+            auto capacity = MinCapacity;
+            while ( maxLoad( capacity ) <= count )
+                capacity <<= 1;
+            return capacity;
+        }
+
+        std::size_t     hashOf( const Key& key ) const
+        {
+            if constexpr ( details::is_avalanching< Hash >::value )
+                return static_cast< std::size_t >( hash_( key ) );
+            else
+                return static_cast< std::size_t >( generics::Hash128to64( static_cast< std::uint64_t >( hash_( key ) ), 0x9E3779B97F4A7C15ULL ) );
+        }
+
+        // the high bits pick the segment, the low ones the slot
+        Segment&        segmentOf( std::size_t hash ) const { return segments_[ ( static_cast< std::uint64_t >( hash ) >> 48 ) & ( segmentCount_ - 1 ) ]; }
+
+        // Under the mutex of the segment (the slots of the table cannot change)
+        std::size_t     findIndex( const Table& table, const Key& key, std::size_t hash ) const
+        {
+            for ( auto index = hash & table.mask; ; index = ( index + 1 ) & table.mask )
+            {
+                const auto& slot = table.slots[ index ];
+                const auto state = stateOf( slot.control.load( std::memory_order_relaxed ) );
+                if ( state == Empty )
+                    return NotFound;
+                if ( state == Full && equal_( slot.key.load( std::memory_order_relaxed ), key ) )
+                    return index;
+            }
+        }
+
+        // Seqlock write: the slot is seen busy before any of its fields changes, and the fields are visible once the new version is
+        template < typename F >
+        static void     writeSlot( Slot& slot, State state, F&& writeFields )
+        {
+            const auto control = slot.control.load( std::memory_order_relaxed );
+            slot.control.store( ( control & ~std::uint32_t( 3 ) ) | Busy, std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_release );
+            writeFields();
+            slot.control.store( ( ( ( control >> 2 ) + 1 ) << 2 ) | state, std::memory_order_release );
+        }
+
+        static void     publish( Slot& slot, State state )
+        {
+            writeSlot( slot, state, [] { /* NOTHING */ } );
+        }
+
+        bool    write( const Key& key, const Value& value, bool isAssigned )
+        {
+            const auto hash = hashOf( key );
+            auto& segment = segmentOf( hash );
+            std::lock_guard< std::mutex > lock( segment.mutex );
+
+            auto table = segment.table.load( std::memory_order_relaxed );
+            auto target = NotFound;
+            for ( auto index = hash & table->mask; ; index = ( index + 1 ) & table->mask )
+            {
+                auto& slot = table->slots[ index ];
+                const auto state = stateOf( slot.control.load( std::memory_order_relaxed ) );
+                if ( state == Full && equal_( slot.key.load( std::memory_order_relaxed ), key ) )
+                {
+                    if ( isAssigned )
+                        writeSlot( slot, Full, [ & ] { slot.value.store( value, std::memory_order_relaxed ); } );
+                    return false;
+                }
+                if ( state == Deleted && target == NotFound )
+                    target = index; // reused unless the key is further
+                if ( state == Empty )
+                {
+                    if ( target == NotFound )
+                        target = index;
+                    break;
+                }
+            }
+
+            const auto size = segment.size.load( std::memory_order_relaxed );
+            const auto isReusingTombstone = stateOf( table->slots[ target ].control.load( std::memory_order_relaxed ) ) == Deleted;
+            if ( ! isReusingTombstone && size + segment.deleted + 1 > maxLoad( table->capacity() ) )
+            {
+                table = rehash( segment, table, size + 1 );
+                target = hash & table->mask;
+                while ( stateOf( table->slots[ target ].control.load( std::memory_order_relaxed ) ) != Empty )
+                    target = ( target + 1 ) & table->mask;
+            }
+            else if ( isReusingTombstone )
+                --segment.deleted;
+
+            auto& slot = table->slots[ target ];
+            writeSlot( slot, Full, [ & ] { slot.key.store( key, std::memory_order_relaxed ); slot.value.store( value, std::memory_order_relaxed ); } );
+            segment.size.store( size + 1, std::memory_order_relaxed );
+            return true;
+        }
+
+        // Copy the elements of the segment into a new table, publish it and retire the previous one
+        // The capacity doubles when count is above half of it, otherwise the table is only cleaned of its tombstones (at least a quarter of the
+        // capacity is then free for the next insertions): an insertion is amortized O(1)
+        // The readers keep reading the previous table (unchanged) until they see the new one
+        Table*  rehash( Segment& segment, Table* table, std::size_t count )
+        {
+            auto newTable = std::make_unique< Table >( count > table->capacity() / 2 ? 2 * table->capacity() : table->capacity() );
+            for ( std::size_t i = 0; i < table->capacity(); ++i )
+            {
+                const auto& slot = table->slots[ i ];
+                if ( stateOf( slot.control.load( std::memory_order_relaxed ) ) != Full )
+                    continue;
+
+                const auto key = slot.key.load( std::memory_order_relaxed );
+                auto index = hashOf( key ) & newTable->mask;
+                while ( stateOf( newTable->slots[ index ].control.load( std::memory_order_relaxed ) ) != Empty )
+                    index = ( index + 1 ) & newTable->mask;
+
+                auto& newSlot = newTable->slots[ index ];
+                newSlot.key.store( key, std::memory_order_relaxed );
+                newSlot.value.store( slot.value.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+                newSlot.control.store( Full, std::memory_order_relaxed );
+            }
+
+            segment.deleted = 0;
+            segment.table.store( newTable.get(), std::memory_order_release );
+            Reclamation::retire( table );
+            return newTable.release();
+        }
+
+    private:
+        const std::size_t               segmentCount_;
+        std::unique_ptr< Segment[] >    segments_;
+        Hash                            hash_;
+        KeyEqual                        equal_;
+    };
+}
+
+#endif /* ! __CONTAINERS_CONCURRENTHASHMAP_H__ */
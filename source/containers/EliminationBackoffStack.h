@@ -0,0 +1,204 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_ELIMINATIONBACKOFFSTACK_H__
+#define __CONTAINERS_ELIMINATIONBACKOFFSTACK_H__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "containers/ReclaimingLockFreeStack.h"
+#include "tools/CacheInformation.h"
+
+namespace containers
+{
+    // Elimination backoff stack (Hendler, Shavit, Yerushalmi): ReclaimingLockFreeStack + an elimination array used when the CAS on head_ fails
+    // - a push and a pop colliding in the array cancel each other: the pusher offers its node in a random slot, a popper takes it, neither touches head_
+    //   (a push immediately followed by a pop is a valid linearization, so the stack stays linearizable)
+    // - offers are one-sided: a popper CAS the slot from the node to Taken and owns the node (it has never been in the stack, it is deleted directly);
+    //   the slot stays Taken until the pusher acknowledges it, so the node address cannot be offered again in the meantime (no ABA on the withdraw)
+    // - each thread adapts to the contention it observes: the range of slots shrinks when it waits for nothing and widens when it collides with an operation of the same kind;
+    //   when the elimination keeps failing the thread falls back on a bounded exponential backoff, probing the array again from time to time
+    template < typename T, typename Reclamation = threading::HazardPointers >
+    class EliminationBackoffStack : private ReclaimingLockFreeStack< T, Reclamation >
+    {
+        using Base = ReclaimingLockFreeStack< T, Reclamation >;
+        using Node = typename Base::Node;
+        using PopResult = typename Base::PopResult;
+
+    public:
+        using value_type = T;
+
+        EliminationBackoffStack()
+        {
+            for ( auto& slot : slots_ )
+                slot.offer.store( nullptr, std::memory_order_relaxed );
+        }
+
+        template < typename... Args >
+        void    emplace( Args&&... args )
+        {
+            auto node = new Node( std::forward< Args >( args )... );
+            while ( ! this->tryPushNode( node ) )
+                if ( onContention( [ this, node ] ( std::size_t slot ) { return tryEliminatePush( slot, node ); } ) )
+                    return;
+        }
+
+        void    push( const T& value ) { emplace( value ); }
+        void    push( T&& value ) { emplace( std::move( value ) ); }
+
+        // Return false if the stack is empty
+        bool    pop( T& value )
+        {
+            typename Reclamation::Guard guard;
+            for ( ;; )
+            {
+                Node* node;
+                switch ( this->tryPopNode( guard, node ) )
+                {
+                case PopResult::Popped:
+                    value = std::move( node->value );
+                    guard.reset();
+                    Reclamation::retire( node );
+                    return true;
+                case PopResult::Empty:
+                    return false;
+                case PopResult::Contended:
+                    if ( onContention( [ this, &value ] ( std::size_t slot ) { return tryEliminatePop( slot, value ); } ) )
+                        return true;
+                    break;
+                }
+            }
+        }
+
+        using Base::empty;
+
+    private:
+        static constexpr const std::size_t  EliminationWidth = 16;
+        static constexpr const int          EliminationSpin = 128;   // iterations a pusher waits for a popper / a popper looks for an offer
+        static constexpr const unsigned     MaxBackoff = 1024;
+        static constexpr const int          MaxScore = 8;
+
+        enum class Elimination { Done, Timeout, Collision };
+
+        struct alignas( tools::CacheLineSize ) Slot
+        {
+            std::atomic< Node* >    offer;
+        };
+
+        // Per thread view of the contention
+        struct Contention
+        {
+            std::size_t     range = 1;              // slots used: [0, range)
+            int             score = 0;              // > 0: elimination succeeds often enough, < 0: backoff instead
+            unsigned        backoff = 1;
+            unsigned        conflicts = 0;
+            std::uint32_t   random = static_cast< std::uint32_t >( std::hash< std::thread::id >()( std::this_thread::get_id() ) ) | 1; // xorshift state, never 0
+        };
+
+        static Node*        taken() { return reinterpret_cast< Node* >( static_cast< std::uintptr_t >( 1 ) ); }
+
+        static Contention&  contention()
+        {
+            static thread_local Contention c;
+            return c;
+        }
+
+        static std::size_t  randomSlot( Contention& c )
+        {
+            c.random ^= c.random << 13;
+            c.random ^= c.random >> 17;
+            c.random ^= c.random << 5;
+            return c.random % c.range;
+        }
+
+        static void     spin( unsigned iterations )
+        {
+            for ( volatile unsigned i = 0; i < iterations; ++i )
+                ;
+        }
+
+        // Called after a failed CAS on head_, return true if the operation was eliminated (false: retry on head_)
+        template < typename TryEliminate >
+        bool    onContention( TryEliminate&& tryEliminate )
+        {
+            auto& c = contention();
+            if ( c.score < 0 && ++c.conflicts % 8 != 0 )
+            {
+                spin( c.backoff );
+                c.backoff = std::min( c.backoff * 2, MaxBackoff );
+                return false;
+            }
+
+            switch ( tryEliminate( randomSlot( c ) ) )
+            {
+            case Elimination::Done:
+                c.score = std::min( c.score + 1, MaxScore );
+                c.backoff = 1;
+                return true;
+            case Elimination::Timeout: // nobody to pair with at this range
+                c.range = std::max< std::size_t >( c.range / 2, 1 );
+                --c.score;
+                return false;
+            case Elimination::Collision: // slot busy with an operation of the same kind
+                c.range = std::min( c.range * 2, EliminationWidth );
+                return false;
+            }
+            return false;
+        }
+
+        Elimination     tryEliminatePush( std::size_t slotIndex, Node* node )
+        {
+            auto& offer = slots_[ slotIndex ].offer;
+            Node* expected = nullptr;
+            if ( ! offer.compare_exchange_strong( expected, node, std::memory_order_release, std::memory_order_relaxed ) )
+                return Elimination::Collision;
+
+            for ( auto i = 0; i < EliminationSpin; ++i )
+                if ( offer.load( std::memory_order_acquire ) == taken() )
+                {
+                    offer.store( nullptr, std::memory_order_release );
+                    return Elimination::Done;
+                }
+
+            // withdraw, unless a popper took the node in the meantime
+            expected = node;
+            if ( offer.compare_exchange_strong( expected, nullptr, std::memory_order_acquire, std::memory_order_acquire ) )
+                return Elimination::Timeout;
+
+            offer.store( nullptr, std::memory_order_release );
+            return Elimination::Done;
+        }
+
+        Elimination     tryEliminatePop( std::size_t slotIndex, T& value )
+        {
+            auto& offer = slots_[ slotIndex ].offer;
+            for ( auto i = 0; i < EliminationSpin; ++i )
+            {
+                auto node = offer.load( std::memory_order_acquire );
+                if ( node == nullptr || node == taken() )
+                    continue;
+
+                if ( offer.compare_exchange_strong( node, taken(), std::memory_order_acquire, std::memory_order_relaxed ) )
+                {
+                    value = std::move( node->value );
+                    delete node;
+                    return Elimination::Done;
+                }
+                return Elimination::Collision; // another popper was faster
+            }
+            return Elimination::Timeout;
+        }
+
+    private:
+        std::array< Slot, EliminationWidth >    slots_;
+    };
+}
+
+#endif /* ! __CONTAINERS_ELIMINATIONBACKOFFSTACK_H__ */
@@ -0,0 +1,649 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_FLATHASHMAP_H__
+#define __CONTAINERS_FLATHASHMAP_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+# include <emmintrin.h>
+# define CONTAINERS_FLATHASHMAP_SSE2
+#endif
+
+#include "generic/Bits.h"
+#include "generic/FastHash.h"
+#include "generic/HashCombine.h"
+
+namespace containers
+{
+    namespace details
+    {
+        // Control byte of a FlatHashMap slot: empty, deleted (tombstone), or the 7 low bits of the hash of its key (H2) when full
+        using ControlByte = std::int8_t;
+
+        static constexpr const ControlByte  ControlEmpty = -128;
+        static constexpr const ControlByte  ControlDeleted = -2;
+
+        inline bool     isFull( ControlByte control ) { return control >= 0; }
+
+        // Control bytes of Width consecutive slots, matched at once (one bit per slot in the result, slot i is bit i)
+        class ControlGroup
+        {
+        public:
+            static constexpr const std::size_t  Width = 16;
+
+            explicit ControlGroup( const ControlByte* controls )
+#ifdef CONTAINERS_FLATHASHMAP_SSE2
+                : controls_( _mm_loadu_si128( reinterpret_cast< const __m128i* >( controls ) ) )
+#else
+                : controls_( controls )
+#endif
+            {
+                // NOTHING
+            }
+
+#ifdef CONTAINERS_FLATHASHMAP_SSE2
+            std::uint32_t   match( ControlByte h2 ) const { return mask( _mm_cmpeq_epi8( controls_, _mm_set1_epi8( h2 ) ) ); }
+            std::uint32_t   matchEmpty() const { return mask( _mm_cmpeq_epi8( controls_, _mm_set1_epi8( ControlEmpty ) ) ); }
+
+            // empty and deleted are the only negative values below -1
+            std::uint32_t   matchEmptyOrDeleted() const { return mask( _mm_cmpgt_epi8( _mm_set1_epi8( -1 ), controls_ ) ); }
+
+        private:
+            static std::uint32_t    mask( __m128i matches ) { return static_cast< std::uint32_t >( _mm_movemask_epi8( matches ) ); }
+
+            __m128i     controls_;
+#else
+            std::uint32_t   match( ControlByte h2 ) const { return matchIf( [ h2 ] ( ControlByte c ) { return c == h2; } ); }
+            std::uint32_t   matchEmpty() const { return matchIf( [] ( ControlByte c ) { return c == ControlEmpty; } ); }
+            std::uint32_t   matchEmptyOrDeleted() const { return matchIf( [] ( ControlByte c ) { return c < -1; } ); }
+
+        private:
+            template < typename Predicate >
+            std::uint32_t   matchIf( Predicate predicate ) const
+            {
+                std::uint32_t result = 0;
+                for ( std::size_t i = 0; i < Width; ++i )
+                    result |= std::uint32_t( predicate( controls_[ i ] ) ) << i;
+                return result;
+            }
+
+            const ControlByte*  controls_;
+#endif
+        };
+
+        template < typename T, typename = void >
+        struct is_transparent : std::false_type
+        {
+            // NOTHING
+        };
+
+        template < typename T >
+        struct is_transparent< T, std::void_t< typename T::is_transparent > > : std::true_type
+        {
+            // NOTHING
+        };
+
+        // the hash is usable as is, every bit depending on every bit of the key
+        template < typename T, typename = void >
+        struct is_avalanching : std::false_type
+        {
+            // NOTHING
+        };
+
+        template < typename T >
+        struct is_avalanching< T, std::void_t< typename T::is_avalanching > > : std::true_type
+        {
+            // NOTHING
+        };
+    }
+
+    // Open addressing hash map with the values stored in place (Swiss table, as absl::flat_hash_map)
+    // - one control byte per slot: empty, deleted, or the 7 low bits of the hash (H2) when full
+    // - a lookup loads the control bytes of 16 slots at once and compares them to H2 with SSE2: the keys are only compared on a H2 match,
+    //   and the probe stops at the first group with an empty slot. The probe moves by groups (triangular steps), starting at the other bits of the hash (H1)
+    // - the capacity is a power of 2, the map grows (doubles) when the slots full or deleted reach 7 / 8 of it
+    // - erase leaves a tombstone only if a probe could have gone through the slot (no empty slot around it), the tombstones
+    //   are then reclaimed in place when they are the reason to grow
+    // The hash of Hash is mixed (Hash128to64) before use unless Hash defines is_avalanching (as the default generics::FastHash):
+    // std::hash is the identity for the integers, the low bits of which would be the only ones used
+    // Hash and KeyEqual defining is_transparent enable the heterogeneous lookups (e.g. find( std::string_view ) on std::string keys, with std::equal_to<>)
+    // The references and iterators are invalidated by the insertions which grow the map, and by erase for the erased element only
+    template < typename Key, typename Value, typename Hash = generics::FastHash, typename KeyEqual = std::equal_to< Key > >
+    class FlatHashMap
+    {
+        using ControlByte = details::ControlByte;
+        using ControlGroup = details::ControlGroup;
+
+        // heterogeneous lookup only with a transparent Hash and KeyEqual
+        static constexpr const bool     IsTransparent = details::is_transparent< Hash >::value && details::is_transparent< KeyEqual >::value;
+
+        template < typename K >
+        using Transparent = std::enable_if_t< IsTransparent, K >;
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair< const Key, Value >;
+        using size_type = std::size_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+
+        // Forward iterator over the full slots
+        template < bool IsConst >
+        class Iterator
+        {
+        public:
+            using Map = std::conditional_t< IsConst, const FlatHashMap, FlatHashMap >;
+            using value_type = typename FlatHashMap::value_type;
+            using reference = std::conditional_t< IsConst, const value_type&, value_type& >;
+            using pointer = std::conditional_t< IsConst, const value_type*, value_type* >;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+
+            Iterator() = default;
+
+            // an iterator is a const_iterator too
+            template < bool OtherIsConst, typename = std::enable_if_t< IsConst && ! OtherIsConst > >
+            Iterator( const Iterator< OtherIsConst >& other )
+                : map_( other.map_ )
+                , index_( other.index_ )
+            {
+                // NOTHING
+            }
+
+            reference   operator*() const { return map_->slots_[ index_ ]; }
+            pointer     operator->() const { return map_->slots_ + index_; }
+
+            Iterator&   operator++()
+            {
+                ++index_;
+                skipFree();
+                return *this;
+            }
+
+            Iterator    operator++( int )
+            {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            bool    operator==( const Iterator& other ) const { return index_ == other.index_; }
+            bool    operator!=( const Iterator& other ) const { return index_ != other.index_; }
+
+        private:
+            friend class FlatHashMap;
+
+            template < bool >
+            friend class Iterator;
+
+            Iterator( Map& map, std::size_t index )
+                : map_( &map )
+                , index_( index )
+            {
+                // NOTHING
+            }
+
+            void    skipFree()
+            {
+                while ( index_ < map_->capacity_ && ! details::isFull( map_->controls_[ index_ ] ) )
+                    ++index_;
+            }
+
+            Map*            map_ = nullptr;
+            std::size_t     index_ = 0;
+        };
+
+        using iterator = Iterator< false >;
+        using const_iterator = Iterator< true >;
+
+        FlatHashMap()
+            : slots_( nullptr )
+            , capacity_( 0 )
+            , size_( 0 )
+            , growthLeft_( 0 )
+        {
+            // NOTHING
+        }
+
+        explicit FlatHashMap( std::size_t count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual() )
+            : FlatHashMap()
+        {
+            hash_ = hash;
+            equal_ = equal;
+            reserve( count );
+        }
+
+        FlatHashMap( std::initializer_list< value_type > values )
+            : FlatHashMap()
+        {
+            reserve( values.size() );
+            for ( const auto& value : values )
+                insert( value );
+        }
+
+        FlatHashMap( const FlatHashMap& other )
+            : FlatHashMap()
+        {
+            hash_ = other.hash_;
+            equal_ = other.equal_;
+            reserve( other.size_ );
+            for ( const auto& value : other )
+                insert( value );
+        }
+
+        FlatHashMap( FlatHashMap&& other ) noexcept
+            : FlatHashMap()
+        {
+            swap( other );
+        }
+
+        FlatHashMap& operator=( FlatHashMap other ) noexcept
+        {
+            swap( other );
+            return *this;
+        }
+
+        ~FlatHashMap()
+        {
+            destroySlots();
+            deallocate( slots_, capacity_ );
+        }
+
+        void    swap( FlatHashMap& other ) noexcept
+        {
+            std::swap( controls_, other.controls_ );
+            std::swap( slots_, other.slots_ );
+            std::swap( capacity_, other.capacity_ );
+            std::swap( size_, other.size_ );
+            std::swap( growthLeft_, other.growthLeft_ );
+            std::swap( hash_, other.hash_ );
+            std::swap( equal_, other.equal_ );
+        }
+
+        std::size_t     size() const { return size_; }
+        bool            empty() const { return size_ == 0; }
+        std::size_t     capacity() const { return capacity_; }
+        float           load_factor() const { return capacity_ == 0 ? 0.f : static_cast< float >( size_ ) / capacity_; }
+
+        iterator        begin() { return firstFull< iterator >( *this ); }
+        iterator        end() { return iterator( *this, capacity_ ); }
+        const_iterator  begin() const { return firstFull< const_iterator >( *this ); }
+        const_iterator  end() const { return const_iterator( *this, capacity_ ); }
+        const_iterator  cbegin() const { return begin(); }
+        const_iterator  cend() const { return end(); }
+
+        // Unless Hash and KeyEqual are transparent, key is converted to Key before being hashed (e.g. emplace( 1, v ) on double keys hashes 1.0)
+        template < typename K, typename... Args >
+        std::pair< iterator, bool >     try_emplace( K&& key, Args&&... args )
+        {
+            if constexpr ( IsTransparent || std::is_same< std::decay_t< K >, Key >::value )
+                return emplaceKey( std::forward< K >( key ), std::forward< Args >( args )... );
+            else
+                return emplaceKey( Key( std::forward< K >( key ) ), std::forward< Args >( args )... );
+        }
+
+        template < typename K, typename V >
+        std::pair< iterator, bool >     emplace( K&& key, V&& value ) { return try_emplace( std::forward< K >( key ), std::forward< V >( value ) ); }
+
+        std::pair< iterator, bool >     insert( const value_type& value ) { return try_emplace( value.first, value.second ); }
+        std::pair< iterator, bool >     insert( value_type&& value ) { return try_emplace( value.first, std::move( value.second ) ); }
+
+        template < typename K >
+        std::pair< iterator, bool >     insert_or_assign( K&& key, Value value )
+        {
+            auto result = try_emplace( std::forward< K >( key ), std::move( value ) );
+            if ( ! result.second )
+                result.first->second = std::move( value );
+            return result;
+        }
+
+        Value&  operator[]( const Key& key ) { return try_emplace( key ).first->second; }
+        Value&  operator[]( Key&& key ) { return try_emplace( std::move( key ) ).first->second; }
+
+        iterator        find( const Key& key ) { return iterator( *this, findOrEnd( key ) ); }
+        const_iterator  find( const Key& key ) const { return const_iterator( *this, findOrEnd( key ) ); }
+        bool            contains( const Key& key ) const { return findIndex( key, hashOf( key ) ) != NotFound; }
+        std::size_t     count( const Key& key ) const { return contains( key ) ? 1 : 0; }
+
+        template < typename K, typename = Transparent< K > >
+        iterator        find( const K& key ) { return iterator( *this, findOrEnd( key ) ); }
+
+        template < typename K, typename = Transparent< K > >
+        const_iterator  find( const K& key ) const { return const_iterator( *this, findOrEnd( key ) ); }
+
+        template < typename K, typename = Transparent< K > >
+        bool            contains( const K& key ) const { return findIndex( key, hashOf( key ) ) != NotFound; }
+
+        template < typename K, typename = Transparent< K > >
+        std::size_t     count( const K& key ) const { return contains( key ) ? 1 : 0; }
+
+        Value&          at( const Key& key ) { return slots_[ findIndexChecked( key ) ].second; }
+        const Value&    at( const Key& key ) const { return slots_[ findIndexChecked( key ) ].second; }
+
+        // 0 if there is no such key
+        std::size_t     erase( const Key& key ) { return eraseKey( key ); }
+
+        template < typename K, typename = Transparent< K > >
+        std::size_t     erase( const K& key ) { return eraseKey( key ); }
+
+        // iterator following position
+        iterator    erase( const_iterator position )
+        {
+            eraseAt( position.index_ );
+            iterator result( *this, position.index_ );
+            result.skipFree();
+            return result;
+        }
+
+        iterator    erase( iterator position ) { return erase( const_iterator( position ) ); }
+
+        // Enough room for count elements without growing, the capacity is never reduced
+        void    reserve( std::size_t count )
+        {
+            if ( count <= size_ + growthLeft_ )
+                return;
+
+            auto capacity = MinCapacity;
+            while ( maxLoad( capacity ) < count )
+                capacity *= 2;
+            resize( capacity );
+        }
+
+        // Keep the capacity
+        void    clear()
+        {
+            destroySlots();
+            if ( capacity_ > 0 )
+                std::memset( controls_.get(), details::ControlEmpty, capacity_ + ControlGroup::Width );
+            size_ = 0;
+            growthLeft_ = maxLoad( capacity_ );
+        }
+
+    private:
+        static constexpr const std::size_t  NotFound = static_cast< std::size_t >( -1 );
+        static constexpr const std::size_t  MinCapacity = ControlGroup::Width;
+
+        static constexpr std::size_t    maxLoad( std::size_t capacity ) { return capacity - capacity / 8; }
+
+        // H1 picks the first group, H2 is the control byte
+        static std::size_t      h1( std::size_t hash ) { return hash >> 7; }
+        static ControlByte      h2( std::size_t hash ) { return static_cast< ControlByte >( hash & 0x7F ); }
+
+        template < typename K >
+        std::size_t     hashOf( const K& key ) const
+        {
+            if constexpr ( details::is_avalanching< Hash >::value )
+                return static_cast< std::size_t >( hash_( key ) );
+            else
+                return static_cast< std::size_t >( generics::Hash128to64( static_cast< std::uint64_t >( hash_( key ) ), 0x9E3779B97F4A7C15ULL ) );
+        }
+
+        std::size_t     mask() const { return capacity_ - 1; }
+
+        template < typename K >
+        std::size_t     findIndex( const K& key, std::size_t hash ) const
+        {
+            if ( capacity_ == 0 )
+                return NotFound;
+
+            // there is always an empty slot (maxLoad < capacity), and the triangular steps visit every group
+            const auto h2Hash = h2( hash );
+            for ( std::size_t offset = h1( hash ) & mask(), step = 0; ; )
+            {
+                const ControlGroup group( controls_.get() + offset );
+                for ( auto matches = group.match( h2Hash ); matches != 0; matches &= matches - 1 )
+                {
+                    const auto index = ( offset + generics::countTrailingZeros( matches ) ) & mask();
+                    if ( equal_( slots_[ index ].first, key ) )
+                        return index;
+                }
+                if ( group.matchEmpty() != 0 )
+                    return NotFound;
+
+                step += ControlGroup::Width;
+                offset = ( offset + step ) & mask();
+            }
+        }
+
+        template < typename K >
+        std::size_t     findOrEnd( const K& key ) const
+        {
+            const auto index = findIndex( key, hashOf( key ) );
+            return index == NotFound ? capacity_ : index;
+        }
+
+        std::size_t     findIndexChecked( const Key& key ) const
+        {
+            const auto index = findIndex( key, hashOf( key ) );
+            if ( index != NotFound )
+                return index;
+
+            std::ostringstream ss;
+            ss << "FlatHashMap key not found (size " << size_ << ")";
+            throw std::out_of_range( ss.str() );
+        }
+
+        // First empty or deleted slot of the probe of hash
+        std::size_t     findFirstNonFull( std::size_t hash ) const
+        {
+            for ( std::size_t offset = h1( hash ) & mask(), step = 0; ; )
+            {
+                const auto matches = ControlGroup( controls_.get() + offset ).matchEmptyOrDeleted();
+                if ( matches != 0 )
+                    return ( offset + generics::countTrailingZeros( matches ) ) & mask();
+
+                step += ControlGroup::Width;
+                offset = ( offset + step ) & mask();
+            }
+        }
+
+        // Slot where to insert a new key of hash, the map grows (or drops its tombstones) if needed
+        std::size_t     prepareInsert( std::size_t hash )
+        {
+            auto index = capacity_ == 0 ? 0 : findFirstNonFull( hash );
+            if ( growthLeft_ == 0 && ( capacity_ == 0 || controls_[ index ] != details::ControlDeleted ) )
+            {
+                rehashForInsert();
+                index = findFirstNonFull( hash );
+            }
+            return index;
+        }
+
+        void    commitInsert( std::size_t index, std::size_t hash )
+        {
+            if ( controls_[ index ] == details::ControlEmpty )
+                --growthLeft_; // reusing a tombstone does not lengthen any probe
+            setControl( index, h2( hash ) );
+            ++size_;
+        }
+
+        // key is a Key, or a type Hash and KeyEqual accept (transparent)
+        template < typename K, typename... Args >
+        std::pair< iterator, bool >     emplaceKey( K&& key, Args&&... args )
+        {
+            const auto hash = hashOf( key );
+            auto index = findIndex( key, hash );
+            if ( index != NotFound )
+                return { iterator( *this, index ), false };
+
+            index = prepareInsert( hash );
+            ::new ( static_cast< void* >( slots_ + index ) ) value_type( std::piecewise_construct, std::forward_as_tuple( std::forward< K >( key ) ), std::forward_as_tuple( std::forward< Args >( args )... ) );
+            commitInsert( index, hash );
+            return { iterator( *this, index ), true };
+        }
+
+        template < typename K >
+        std::size_t     eraseKey( const K& key )
+        {
+            const auto index = findIndex( key, hashOf( key ) );
+            if ( index == NotFound )
+                return 0;
+
+            eraseAt( index );
+            return 1;
+        }
+
+        void    eraseAt( std::size_t index )
+        {
+            slots_[ index ].~value_type();
+            --size_;
+
+            // A probe only goes through a slot if it found the Width slots of its group full: if every window of Width slots containing the slot
+            // has an empty slot (i.e. empty slots less than Width apart on both sides), no probe went through it and it becomes empty again
+            const auto emptyBefore = ControlGroup( controls_.get() + ( ( index - ControlGroup::Width ) & mask() ) ).matchEmpty();
+            const auto emptyAfter = ControlGroup( controls_.get() + index ).matchEmpty();
+            const auto wasNeverFull = emptyBefore != 0 && emptyAfter != 0
+                                   && generics::countTrailingZeros( emptyAfter ) + ( generics::countLeadingZeros( emptyBefore ) - ( 64 - ControlGroup::Width ) ) < ControlGroup::Width;
+            if ( wasNeverFull )
+            {
+                setControl( index, details::ControlEmpty );
+                ++growthLeft_;
+            }
+            else
+                setControl( index, details::ControlDeleted );
+        }
+
+        // The first Width control bytes are cloned after the last one: a group can be loaded from any slot
+        void    setControl( std::size_t index, ControlByte control )
+        {
+            controls_[ index ] = control;
+            if ( index < ControlGroup::Width )
+                controls_[ capacity_ + index ] = control;
+        }
+
+        void    rehashForInsert()
+        {
+            // no room left mostly because of the tombstones: they are dropped in place, the map grows otherwise
+            if ( capacity_ > ControlGroup::Width && size_ * 32 <= capacity_ * 25 )
+                dropDeletesWithoutResize();
+            else
+                resize( capacity_ == 0 ? MinCapacity : capacity_ * 2 );
+        }
+
+        void    resize( std::size_t capacity )
+        {
+            std::unique_ptr< ControlByte[] > controls( new ControlByte[ capacity + ControlGroup::Width ] );
+            std::memset( controls.get(), details::ControlEmpty, capacity + ControlGroup::Width );
+            auto oldSlots = std::exchange( slots_, allocate( capacity ) );
+            auto oldControls = std::exchange( controls_, std::move( controls ) );
+            const auto oldCapacity = std::exchange( capacity_, capacity );
+
+            for ( std::size_t i = 0; i < oldCapacity; ++i )
+                if ( details::isFull( oldControls[ i ] ) )
+                {
+                    const auto hash = hashOf( oldSlots[ i ].first );
+                    const auto index = findFirstNonFull( hash );
+                    moveSlot( oldSlots + i, slots_ + index );
+                    setControl( index, h2( hash ) );
+                }
+            growthLeft_ = maxLoad( capacity_ ) - size_;
+            deallocate( oldSlots, oldCapacity );
+        }
+
+        // Every element is moved to the first free slot of its probe (as when inserted into an empty map), in place:
+        // - full becomes deleted (to place), deleted becomes empty
+        // - an element already in the first group of its probe stays, otherwise it goes to an empty slot, or is swapped with another element
+        //   to place (which is then placed from the freed slot)
+        void    dropDeletesWithoutResize()
+        {
+            for ( std::size_t i = 0; i < capacity_; ++i )
+                controls_[ i ] = details::isFull( controls_[ i ] ) ? details::ControlDeleted : details::ControlEmpty;
+            std::memcpy( controls_.get() + capacity_, controls_.get(), ControlGroup::Width );
+
+            for ( std::size_t i = 0; i < capacity_; ++i )
+            {
+                if ( controls_[ i ] != details::ControlDeleted )
+                    continue;
+
+                const auto hash = hashOf( slots_[ i ].first );
+                const auto target = findFirstNonFull( hash );
+                const auto probeStart = h1( hash ) & mask();
+                const auto probeGroup = [ & ] ( std::size_t index ) { return ( ( index - probeStart ) & mask() ) / ControlGroup::Width; };
+                if ( probeGroup( target ) == probeGroup( i ) )
+                {
+                    setControl( i, h2( hash ) );
+                    continue;
+                }
+
+                if ( controls_[ target ] == details::ControlEmpty )
+                {
+                    moveSlot( slots_ + i, slots_ + target );
+                    setControl( target, h2( hash ) );
+                    setControl( i, details::ControlEmpty );
+                }
+                else
+                {
+                    swapSlots( slots_ + i, slots_ + target );
+                    setControl( target, h2( hash ) );
+                    --i; // the element swapped in i is placed next
+                }
+            }
+            growthLeft_ = maxLoad( capacity_ ) - size_;
+        }
+
+        // The keys are const: the slots are moved by move construction (copy of the key) then destruction
+        static void     moveSlot( value_type* from, value_type* to )
+        {
+            ::new ( static_cast< void* >( to ) ) value_type( std::move( *from ) );
+            from->~value_type();
+        }
+
+        static void     swapSlots( value_type* a, value_type* b )
+        {
+            value_type tmp( std::move( *a ) );
+            a->~value_type();
+            moveSlot( b, a );
+            ::new ( static_cast< void* >( b ) ) value_type( std::move( tmp ) );
+        }
+
+        void    destroySlots()
+        {
+            for ( std::size_t i = 0; i < capacity_; ++i )
+                if ( details::isFull( controls_[ i ] ) )
+                    slots_[ i ].~value_type();
+        }
+
+        static value_type*  allocate( std::size_t capacity ) { return std::allocator< value_type >().allocate( capacity ); }
+
+        static void     deallocate( value_type* slots, std::size_t capacity )
+        {
+            if ( slots != nullptr )
+                std::allocator< value_type >().deallocate( slots, capacity );
+        }
+
+        template < typename It, typename Self >
+        static It       firstFull( Self& self )
+        {
+            It result( self, 0 );
+            result.skipFree();
+            return result;
+        }
+
+    private:
+        std::unique_ptr< ControlByte[] >    controls_;      // capacity_ + Width bytes
+        value_type*                         slots_;
+        std::size_t                         capacity_;
+        std::size_t                         size_;
+        std::size_t                         growthLeft_;    // insertions into an empty slot before rehashing
+        Hash                                hash_;
+        KeyEqual                            equal_;
+    };
+}
+
+#endif /* ! __CONTAINERS_FLATHASHMAP_H__ */
@@ -0,0 +1,205 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_HIERARCHICALBITSET_H__
+#define __CONTAINERS_HIERARCHICALBITSET_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "generic/Bits.h"
+
+namespace containers
+{
+    // Bitset of N bits for large and mostly empty universes
+    // - level 0 holds the bits, 64 per word
+    // - each bit of level l + 1 tells if the matching word of level l is non zero, up to a single top word
+    // Finding the first / next bit set and the emptiness checks are O(levels) (e.g. 4 levels for 16M bits)
+    // Visiting or clearing the bits set is O(bits set * levels), the count is maintained
+    template < std::size_t N >
+    class HierarchicalBitset
+    {
+        static_assert( N > 0, "Empty HierarchicalBitset" );
+
+    public:
+        static constexpr const std::size_t  WordBits = 64;
+
+        HierarchicalBitset()
+            : count_( 0 )
+        {
+            // NOTHING
+        }
+
+        static constexpr std::size_t    size() { return N; }
+        std::size_t                     count() const { return count_; }
+        bool                            any() const { return words_[ Offsets[ LevelCount - 1 ] ] != 0; }
+        bool                            none() const { return ! any(); }
+
+        bool    test( std::size_t index ) const
+        {
+            return ( words_[ index / WordBits ] >> ( index % WordBits ) ) & 1;
+        }
+
+        // return false if the bit was already set
+        bool    set( std::size_t index )
+        {
+            for ( std::size_t level = 0; level < LevelCount; ++level, index /= WordBits )
+            {
+                auto& word = words_[ Offsets[ level ] + index / WordBits ];
+                const auto bit = std::uint64_t( 1 ) << ( index % WordBits );
+                const auto wasEmpty = word == 0;
+                if ( level == 0 )
+                {
+                    if ( word & bit )
+                        return false;
+                    ++count_;
+                }
+                word |= bit;
+                if ( ! wasEmpty )
+                    break; // the upper levels already mark the word
+            }
+            return true;
+        }
+
+        // return false if the bit was not set
+        bool    reset( std::size_t index )
+        {
+            if ( ! test( index ) )
+                return false;
+
+            --count_;
+            for ( std::size_t level = 0; level < LevelCount; ++level, index /= WordBits )
+            {
+                auto& word = words_[ Offsets[ level ] + index / WordBits ];
+                word &= ~( std::uint64_t( 1 ) << ( index % WordBits ) );
+                if ( word != 0 )
+                    break; // the word is still marked by the upper levels
+            }
+            return true;
+        }
+
+        void    reset()
+        {
+            clearWord( LevelCount - 1, 0 );
+            count_ = 0;
+        }
+
+        // reset the bits set in [ first, last [
+        void    reset( std::size_t first, std::size_t last )
+        {
+            for ( auto index = findFrom( first ); index < last; index = findNext( index ) )
+                reset( index );
+        }
+
+        // N if there is none
+        std::size_t     findFirst() const { return findFrom( 0 ); }
+
+        // first bit set after index, N if there is none
+        std::size_t     findNext( std::size_t index ) const { return findFrom( index + 1 ); }
+
+        // first bit set from index (included), N if there is none
+        std::size_t     findFrom( std::size_t index ) const
+        {
+            if ( index >= N )
+                return N;
+
+            // climb until a word has a bit set at or after the position
+            std::size_t level = 0;
+            for ( ;; )
+            {
+                const auto word = index / WordBits;
+                const auto bits = words_[ Offsets[ level ] + word ] & ~generics::lowerBitsMask( static_cast< unsigned >( index % WordBits ) );
+                if ( bits != 0 )
+                {
+                    index = word * WordBits + generics::countTrailingZeros( bits );
+                    break;
+                }
+
+                if ( ++level == LevelCount )
+                    return N;
+                index = word + 1; // the next words of the level below are the next bits of this level
+                if ( index >= WordCounts[ level - 1 ] )
+                    return N;
+            }
+
+            // descend to the lowest bit set of the marked words
+            while ( level-- > 0 )
+                index = index * WordBits + generics::countTrailingZeros( words_[ Offsets[ level ] + index ] );
+            return index;
+        }
+
+        // f( index ) on each bit set, in order
+        // The words are copied before being walked: f can reset bits, the bits it sets may not be visited
+        template < typename F >
+        void    forEach( F&& f ) const
+        {
+            forEachInWord( LevelCount - 1, 0, f );
+        }
+
+        // Words of level 0
+        static constexpr std::size_t    wordCount() { return WordCounts[ 0 ]; }
+        std::uint64_t                   word( std::size_t i ) const { return words_[ i ]; }
+
+    private:
+        static constexpr std::size_t    computeLevelCount()
+        {
+            std::size_t result = 1;
+            for ( auto words = ( N + WordBits - 1 ) / WordBits; words > 1; words = ( words + WordBits - 1 ) / WordBits )
+                ++result;
+            return result;
+        }
+
+        static constexpr const std::size_t  LevelCount = computeLevelCount();
+
+        static constexpr std::array< std::size_t, LevelCount >  computeWordCounts()
+        {
+            std::array< std::size_t, LevelCount > result {};
+            result[ 0 ] = ( N + WordBits - 1 ) / WordBits;
+            for ( std::size_t level = 1; level < LevelCount; ++level )
+                result[ level ] = ( result[ level - 1 ] + WordBits - 1 ) / WordBits;
+            return result;
+        }
+
+        static constexpr std::array< std::size_t, LevelCount >  computeOffsets()
+        {
+            std::array< std::size_t, LevelCount > result {};
+            for ( std::size_t level = 1; level < LevelCount; ++level )
+                result[ level ] = result[ level - 1 ] + computeWordCounts()[ level - 1 ];
+            return result;
+        }
+
+        static constexpr const std::array< std::size_t, LevelCount >    WordCounts = computeWordCounts();
+        static constexpr const std::array< std::size_t, LevelCount >    Offsets = computeOffsets();
+        static constexpr const std::size_t                              TotalWordCount = Offsets[ LevelCount - 1 ] + 1;
+
+        template < typename F >
+        void    forEachInWord( std::size_t level, std::size_t word, F& f ) const
+        {
+            for ( auto bits = words_[ Offsets[ level ] + word ]; bits != 0; bits &= bits - 1 )
+            {
+                const auto index = word * WordBits + generics::countTrailingZeros( bits );
+                if ( level == 0 )
+                    f( index );
+                else
+                    forEachInWord( level - 1, index, f );
+            }
+        }
+
+        void    clearWord( std::size_t level, std::size_t word )
+        {
+            auto& bits = words_[ Offsets[ level ] + word ];
+            if ( level > 0 )
+                for ( auto children = bits; children != 0; children &= children - 1 )
+                    clearWord( level - 1, word * WordBits + generics::countTrailingZeros( children ) );
+            bits = 0;
+        }
+
+    private:
+        std::array< std::uint64_t, TotalWordCount >     words_ {};
+        std::size_t                                     count_;
+    };
+}
+
+#endif /* ! __CONTAINERS_HIERARCHICALBITSET_H__ */
@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_INTRUSIVEQUEUEMPSC_H__
+#define __CONTAINERS_INTRUSIVEQUEUEMPSC_H__
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+#include "tools/CacheInformation.h"
+
+namespace containers
+{
+    // Base hook, the element to be pushed in IntrusiveQueueMPSC must inherit from it (the link lives in the message, no allocation)
+    struct MPSCQueueHook
+    {
+        MPSCQueueHook()
+            : next( nullptr )
+        {
+            // NOTHING
+        }
+
+        // as boost intrusive hooks, copying an element does not copy its link
+        MPSCQueueHook( const MPSCQueueHook& )
+            : MPSCQueueHook()
+        {
+            // NOTHING
+        }
+
+        MPSCQueueHook& operator=( const MPSCQueueHook& ) { return *this; }
+
+        std::atomic< MPSCQueueHook* >   next;
+    };
+
+    // Unbounded intrusive Multiple Producer Single Consumer queue (based on Dmitry Vyukov intrusive MPSC node-based queue)
+    // - push is wait-free: one atomic exchange on back_ then a store to link the previous element
+    // - pop is done by the consumer only without any read-modify-write; it returns nullptr while a producer is between its exchange and its link (the element is not visible yet),
+    //   i.e. a producer preempted at this point delays the consumer (only the consumer, other producers keep going)
+    // The queue does not own the elements: an element must outlive its stay in the queue and must not be pushed twice before being popped
+    template < typename T >
+    class IntrusiveQueueMPSC
+    {
+        static_assert( std::is_base_of< MPSCQueueHook, T >::value, "T must inherit from MPSCQueueHook" );
+
+    public:
+        IntrusiveQueueMPSC()
+            : back_( &stub_ )
+            , front_( &stub_ )
+        {
+            // NOTHING
+        }
+
+        IntrusiveQueueMPSC( const IntrusiveQueueMPSC& ) = delete;
+        IntrusiveQueueMPSC& operator=( const IntrusiveQueueMPSC& ) = delete;
+
+        // Any thread
+        void    push( T& element )
+        {
+            pushHook( &element );
+        }
+
+        // Consumer only
+        T*      pop()
+        {
+            auto front = front_;
+            auto next = front->next.load( std::memory_order_acquire );
+
+            // skip the stub
+            if ( front == &stub_ )
+            {
+                if ( next == nullptr )
+                    return nullptr;
+
+                front_ = front = next;
+                next = next->next.load( std::memory_order_acquire );
+            }
+
+            if ( next != nullptr )
+            {
+                front_ = next;
+                return static_cast< T* >( front );
+            }
+
+            // front is the last linked element, either a producer is linking a new one or the queue only contains front
+            if ( front != back_.load( std::memory_order_acquire ) )
+                return nullptr;
+
+            // put back the stub behind front so it can be unlinked
+            pushHook( &stub_ );
+            next = front->next.load( std::memory_order_acquire );
+            if ( next != nullptr )
+            {
+                front_ = next;
+                return static_cast< T* >( front );
+            }
+            return nullptr;
+        }
+
+        // Consumer only, pop everything visible and call f( T& ) on each element in FIFO order, return the number of element popped
+        // f can recycle / destroy the element, the queue does not touch it anymore
+        template < typename F >
+        std::size_t     pop_all( F&& f )
+        {
+            std::size_t result = 0;
+            for ( auto element = pop(); element != nullptr; element = pop() )
+            {
+                f( *element );
+                ++result;
+            }
+            return result;
+        }
+
+        // Consumer only
+        bool    empty() const
+        {
+            return front_ == &stub_ && stub_.next.load( std::memory_order_acquire ) == nullptr;
+        }
+
+    private:
+        void    pushHook( MPSCQueueHook* hook )
+        {
+            hook->next.store( nullptr, std::memory_order_relaxed );
+            auto previous = back_.exchange( hook, std::memory_order_acq_rel );
+            previous->next.store( hook, std::memory_order_release ); // link, the element is visible for the consumer from here
+        }
+
+    private:
+        // producers side
+        alignas( tools::CacheLineSize ) std::atomic< MPSCQueueHook* >    back_;
+
+        // consumer side
+        alignas( tools::CacheLineSize ) MPSCQueueHook*                   front_;
+        MPSCQueueHook                                                     stub_;
+    };
+}
+
+#endif /* ! __CONTAINERS_INTRUSIVEQUEUEMPSC_H__ */
@@ -5,113 +5,381 @@
 #ifndef __CONTAINERS_LOCKBASEDQUEUE__
 #define __CONTAINERS_LOCKBASEDQUEUE__
 
-#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace containers
 {
+    // Two locks queue: producers only lock tailMutex_, consumers only lock headMutex_
+    // - values are constructed in place in the nodes, popped nodes are recycled, so there is no allocation in steady state: consumers push them on
+    //   returnedNodes_ (lock-free, never popped node by node hence no ABA), producers take that list whole into their own cache (freeNodes_, under tailMutex_)
+    //   when the cache is empty
+    // - bounded mode (capacity given at construction): the nodes are allocated upfront and push blocks / tryPush fails / tryPushFor times out while the queue is full (backpressure)
+    // - size_ is the number of linked elements, it is with returnedNodes_ the only state shared by both sides; a side only locks the mutex of the other side
+    //   to wake it up, and only if somebody is waiting
     template < typename T >
     struct LockBasedQueue
     {
     public:
-        // init head with a dummy pointer : head_ == tail_ -> empty queue
-        // Use this dummy so that tail_ and head_ are less linked in the case of an empty queue (instead of doing empty queue -> head_ == tail_ == nullptr)
+        // Unbounded
         LockBasedQueue()
-            : head_( new Node )
-            , tail_( head_.get() )
+            : LockBasedQueue( std::numeric_limits< std::size_t >::max(), 0 )
         {
             // NOTHING
         }
 
-        // No link to head -> more fine grained lock
+        // Bounded, allocate all the nodes
+        explicit LockBasedQueue( std::size_t capacity )
+            : LockBasedQueue( capacity, capacity )
+        {
+            // NOTHING
+        }
+
+        LockBasedQueue( const LockBasedQueue& ) = delete;
+        LockBasedQueue& operator=( const LockBasedQueue& ) = delete;
+
+        ~LockBasedQueue()
+        {
+            for ( auto node = head_; node != tail_; node = node->next )
+                node->value().~T();
+            deleteChain( head_ );
+            deleteChain( freeNodes_ );
+            deleteChain( returnedNodes_.load() );
+        }
+
+        // Block while the queue is full
         void    push( T data )
         {
-            auto newData = std::make_shared< T >( std::move( data ) ); 
-            auto newTail = std::make_unique< Node >();
-            auto newTailAddress = newTail.get();
+            emplaceWhen( [ this ] ( std::unique_lock< std::mutex >& lock ) { waitForRoom( lock ); return true; }, std::move( data ) );
+        }
+
+        bool    tryPush( const T& data ) { return emplaceWhen( [ this ] ( std::unique_lock< std::mutex >& ) { return hasRoom(); }, data ); }
+        bool    tryPush( T&& data ) { return emplaceWhen( [ this ] ( std::unique_lock< std::mutex >& ) { return hasRoom(); }, std::move( data ) ); }
+
+        template < typename Rep, typename Period >
+        bool    tryPushFor( T data, const std::chrono::duration< Rep, Period >& timeout )
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            return emplaceWhen( [ this, &deadline ] ( std::unique_lock< std::mutex >& lock ) { return waitForRoom( lock, &deadline ); }, std::move( data ) );
+        }
 
+        // Link the values with a single lock and a single wake-up (in bounded mode, once per batch of free room, blocking while the queue is full)
+        // If a construction throws, the values already constructed stay in the queue
+        template < typename It >
+        void    push_n( It first, It last )
+        {
+            auto remaining = static_cast< std::size_t >( std::distance( first, last ) );
+            while ( remaining != 0 )
             {
-                std::lock_guard< std::mutex >   lock( tailMutex_ );
-                tail_->data = std::move( newData );
-                tail_->next = std::move( newTail );
-                tail_ = newTailAddress;
+                std::size_t n = 0;
+                {
+                    std::unique_lock< std::mutex >  lock( tailMutex_ );
+                    waitForRoom( lock );
+
+                    // the nodes are only taken once the room is known
+                    const auto count = std::min( remaining, capacity_ - size_.load() );
+                    auto chain = acquireNodes( count );
+                    try
+                    {
+                        // first value goes into the current dummy tail_, the last new node is the new dummy
+                        for ( ; n < count; ++n, ++first )
+                        {
+                            new ( &tail_->storage ) T( *first );
+                            tail_->next = std::exchange( chain, chain->next );
+                            tail_ = tail_->next;
+                        }
+                    }
+                    catch ( ... )
+                    {
+                        tail_->next = nullptr;
+                        size_.fetch_add( n );
+                        lock.unlock();
+                        releaseNodes( chain );
+                        if ( n != 0 )
+                            notify( waitingConsumers_, headMutex_, notEmpty_, n > 1 );
+                        throw;
+                    }
+                    tail_->next = nullptr;
+                    size_.fetch_add( n );
+                }
+                remaining -= n;
+                notify( waitingConsumers_, headMutex_, notEmpty_, n > 1 );
             }
-            conditionVariable_.notify_one();
         }
 
-        std::shared_ptr< T >    tryPop()
+        // Detach up to max elements with a single lock, the values are moved to out outside of the lock, return the number of elements popped
+        template < typename OutputIt >
+        std::size_t     pop_n( OutputIt out, std::size_t max )
         {
-            auto previousHead = popHead();
-            return previousHead ? previousHead->data : nullptr;
+            Node* chain = nullptr;
+            std::size_t result = 0;
+            {
+                std::lock_guard< std::mutex >   lock( headMutex_ );
+                result = std::min( max, size_.load() );
+                if ( result == 0 )
+                    return 0;
+
+                chain = head_;
+                auto last = head_;
+                for ( auto i = result; i != 1; --i )
+                    last = last->next;
+                head_ = last->next;
+                last->next = nullptr;
+                size_.fetch_sub( result );
+            }
+            notify( waitingProducers_, tailMutex_, notFull_, result > 1 );
+
+            for ( auto node = chain; node != nullptr; node = node->next )
+            {
+                *out++ = std::move( node->value() );
+                node->value().~T();
+            }
+            releaseNodes( chain );
+            return result;
         }
 
-        std::shared_ptr< T >    waitAndPop()
+        bool    tryPop( T& data )
+        {
+            std::unique_lock< std::mutex >  lock( headMutex_ );
+            if ( size_.load() == 0 )
+                return false;
+
+            popHead( lock, data );
+            return true;
+        }
+
+        void    waitAndPop( T& data )
         {
-            auto previousHead = waitAndPopHead();
-            return previousHead->data;
+            std::unique_lock< std::mutex >  lock( headMutex_ );
+            waitForElement( lock );
+            popHead( lock, data );
         }
 
-        bool        empty() const
+        // Allocate the shared_ptr, prefer the T& overloads
+        std::shared_ptr< T >    tryPop()
         {
-            std::lock_guard< std::mutex >   lock( headMutex_ );
-            return head_.get() == getTailAddress();
+            std::unique_lock< std::mutex >  lock( headMutex_ );
+            if ( size_.load() == 0 )
+                return nullptr;
+
+            std::shared_ptr< T > result;
+            popHead( lock, result );
+            return result;
         }
 
+        std::shared_ptr< T >    waitAndPop()
+        {
+            std::unique_lock< std::mutex >  lock( headMutex_ );
+            waitForElement( lock );
+
+            std::shared_ptr< T > result;
+            popHead( lock, result );
+            return result;
+        }
+
+        // Approximation if called while other threads are running
+        bool            empty() const { return size_.load() == 0; }
+        std::size_t     size() const { return size_.load(); }
+        std::size_t     capacity() const { return capacity_; }
+
     private:
         struct Node
         {
-            std::shared_ptr< T >        data;
-            std::unique_ptr< Node >     next;
+            T&  value() { return *std::launder( reinterpret_cast< T* >( &storage ) ); }
+
+            Node*                                                   next = nullptr;
+            std::aligned_storage_t< sizeof( T ), alignof( T ) >     storage;
         };
 
-    private:
-        Node*   getTailAddress() const
+        // init head with a dummy node : head_ == tail_ -> empty queue
+        // Use this dummy so that tail_ and head_ are less linked in the case of an empty queue (instead of doing empty queue -> head_ == tail_ == nullptr)
+        LockBasedQueue( std::size_t capacity, std::size_t preallocated )
+            : head_( new Node )
+            , tail_( head_ )
+            , size_( 0 )
+            , capacity_( capacity )
+            , waitingConsumers_( 0 )
+            , waitingProducers_( 0 )
+            , freeNodes_( nullptr )
+            , returnedNodes_( nullptr )
         {
-            std::lock_guard< std::mutex >   lock( tailMutex_ );
-            return tail_;
+            for ( ; preallocated != 0; --preallocated )
+            {
+                auto node = new Node;
+                node->next = freeNodes_;
+                freeNodes_ = node;
+            }
         }
 
-        std::unique_ptr< Node >    popHead()
+        static void     deleteChain( Node* node )
         {
-            std::lock_guard< std::mutex >   lock( headMutex_ );
-            return notThreadSafePopHead();
+            while ( node != nullptr )
+                delete std::exchange( node, node->next );
         }
 
-        std::unique_lock< std::mutex >      waitForNewHead()
+        // tailMutex_ must be held, n linked nodes taken from the producers cache first, refilled with all the nodes returned by the consumers so far
+        Node*   acquireNodes( std::size_t n )
         {
-            std::unique_lock< std::mutex >  lock( headMutex_ );
+            Node* chain = nullptr;
+            for ( ; n != 0; --n )
+            {
+                if ( freeNodes_ == nullptr )
+                    freeNodes_ = returnedNodes_.exchange( nullptr, std::memory_order_acquire );
+                if ( freeNodes_ == nullptr )
+                    break;
+
+                auto node = std::exchange( freeNodes_, freeNodes_->next );
+                node->next = chain;
+                chain = node;
+            }
+
+            try
+            {
+                for ( ; n != 0; --n )
+                {
+                    auto node = new Node;
+                    node->next = chain;
+                    chain = node;
+                }
+            }
+            catch ( ... )
+            {
+                releaseNodes( chain );
+                throw;
+            }
+            return chain;
+        }
+
+        // Any thread, no lock needed: the chain is pushed on returnedNodes_ with a single CAS
+        void    releaseNodes( Node* chain )
+        {
+            if ( chain == nullptr )
+                return;
+
+            auto last = chain;
+            while ( last->next != nullptr )
+                last = last->next;
 
-            conditionVariable_.wait( lock, [&] { return head_.get() != getTailAddress(); } );
-            return std::move( lock );
+            last->next = returnedNodes_.load( std::memory_order_relaxed );
+            while ( ! returnedNodes_.compare_exchange_weak( last->next, chain, std::memory_order_release, std::memory_order_relaxed ) );
         }
 
-        std::unique_ptr< Node >     waitAndPopHead()
+        bool    hasRoom() const { return size_.load() < capacity_; }
+
+        // tailMutex_ must be held, wait until there is room (or the deadline is reached if any)
+        bool    waitForRoom( std::unique_lock< std::mutex >& lock, const std::chrono::steady_clock::time_point* deadline = nullptr )
         {
-            std::unique_lock< std::mutex >  lock( waitForNewHead() );
-            return notThreadSafePopHead();
+            if ( hasRoom() )
+                return true;
+
+            ++waitingProducers_;
+            auto result = true;
+            if ( deadline == nullptr )
+                notFull_.wait( lock, [ this ] { return hasRoom(); } );
+            else
+                result = notFull_.wait_until( lock, *deadline, [ this ] { return hasRoom(); } );
+            --waitingProducers_;
+            return result;
         }
 
-        // Very ugly, find a way to factor the code in a cleaner way
-        std::unique_ptr< Node >     notThreadSafePopHead()
+        // headMutex_ must be held
+        void    waitForElement( std::unique_lock< std::mutex >& lock )
         {
-            if ( head_.get() == getTailAddress() )
-                return nullptr;
+            if ( size_.load() != 0 )
+                return;
+
+            ++waitingConsumers_;
+            notEmpty_.wait( lock, [ this ] { return size_.load() != 0; } );
+            --waitingConsumers_;
+        }
+
+        // The whole construction is done under tailMutex_ in order to reuse the dummy tail_ node (a move for push)
+        // The new dummy node is only taken once there is room, a failing tryPush does not touch the free nodes
+        template < typename WaitForRoom, typename U >
+        bool    emplaceWhen( WaitForRoom&& waitForRoom, U&& data )
+        {
+            {
+                std::unique_lock< std::mutex >  lock( tailMutex_ );
+                if ( ! waitForRoom( lock ) )
+                    return false;
 
-            auto previousHead = std::move( head_ );
-            head_ = std::move( previousHead->next );
+                auto newTail = acquireNodes( 1 );
+                try
+                {
+                    new ( &tail_->storage ) T( std::forward< U >( data ) );
+                }
+                catch ( ... )
+                {
+                    lock.unlock();
+                    releaseNodes( newTail );
+                    throw;
+                }
+                tail_->next = newTail;
+                tail_ = newTail;
+                size_.fetch_add( 1 );
+            }
+            notify( waitingConsumers_, headMutex_, notEmpty_, false );
+            return true;
+        }
+
+        // headMutex_ must be held and the queue not empty, release the lock before moving the value out
+        template < typename Out >
+        void    popHead( std::unique_lock< std::mutex >& lock, Out& data )
+        {
+            auto previousHead = head_;
+            head_ = previousHead->next;
+            previousHead->next = nullptr;
+            size_.fetch_sub( 1 );
+            lock.unlock();
+            notify( waitingProducers_, tailMutex_, notFull_, false );
+
+            assign( data, previousHead->value() );
+            previousHead->value().~T();
+            releaseNodes( previousHead );
+        }
+
+        static void     assign( T& data, T& value ) { data = std::move( value ); }
+        static void     assign( std::shared_ptr< T >& data, T& value ) { data = std::make_shared< T >( std::move( value ) ); }
 
-            return previousHead;
+        // size_ has been updated before (seq_cst), and a waiter increments its counter before checking size_ (seq_cst): at least one of them sees the other
+        // Locking the mutex of the waiter guarantees it is either sleeping or has not checked its predicate yet (no lost wake-up)
+        static void     notify( const std::atomic< std::size_t >& waiting, std::mutex& mutex, std::condition_variable& conditionVariable, bool all )
+        {
+            if ( waiting.load() == 0 )
+                return;
+
+            { std::lock_guard< std::mutex > lock( mutex ); }
+            if ( all )
+                conditionVariable.notify_all();
+            else
+                conditionVariable.notify_one();
         }
 
     private:
-        std::unique_ptr< Node >     head_;
+        Node*                       head_;
         mutable std::mutex          headMutex_;
+        std::condition_variable     notEmpty_;
 
-        Node*                       tail_; // owned by head_ ror one of it's sub-node
+        Node*                       tail_; // dummy node, the next value is constructed in it
         mutable std::mutex          tailMutex_;
+        std::condition_variable     notFull_;
+
+        std::atomic< std::size_t >  size_;
+        const std::size_t           capacity_;
+        std::atomic< std::size_t >  waitingConsumers_;
+        std::atomic< std::size_t >  waitingProducers_;
 
-        std::condition_variable     conditionVariable_;
+        Node*                       freeNodes_; // producers cache, under tailMutex_
+        std::atomic< Node* >        returnedNodes_;
     };
 }
 
@@ -4,10 +4,12 @@
 //--------------------------------------------------------------------------------
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 namespace containers
 {
+    // Unbounded and node based (one new + make_shared per push), see RingBufferSPSC for the bounded / allocation free version
     template < typename T >
     class LockFreeQueueSPSC // Single Producer Single Consumer
     {
@@ -75,6 +77,45 @@ namespace containers
 
             tail_.store( newTail );
         }
+
+        // Link the whole batch then publish it with a single store of tail_
+        template < typename It >
+        void    push_n( It first, It last )
+        {
+            if ( first == last )
+                return;
+
+            auto newTail = tail_.load();
+            for ( ; first != last; ++first )
+            {
+                newTail->data = std::make_shared< T >( *first );
+                newTail->next = new Node;
+                newTail = newTail->next;
+            }
+
+            tail_.store( newTail );
+        }
+
+        // Consume up to max elements (moved to out) with a single load of tail_ / store of head_, return the number of elements popped
+        template < typename OutputIt >
+        std::size_t     pop_n( OutputIt out, std::size_t max )
+        {
+            auto head = head_.load();
+            const auto tail = tail_.load();
+
+            std::size_t result = 0;
+            for ( ; result < max && head != tail; ++result )
+            {
+                *out++ = std::move( *head->data );
+
+                auto previousHead = head;
+                head = head->next;
+                delete previousHead;
+            }
+
+            head_.store( head );
+            return result;
+        }
     };
 }
 
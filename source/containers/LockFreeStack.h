@@ -11,6 +11,7 @@
 namespace containers
 {
     // ReferenceCountingPolicy
+    // head_ is a double word (counter + pointer), which is not lock-free on every target, see ReclaimingLockFreeStack for the hazard pointers / epochs version
     template < typename T >
     class LockFreeStack
     {
@@ -77,6 +78,43 @@ namespace containers
             while ( ! head_.compare_exchange_weak( node.ptr->next, node, std::memory_order_release, std::memory_order_relaxed ) );
         }
 
+        // Link the batch privately then publish it with a single CAS (last element ends up on top, as if pushed one by one)
+        template < typename It >
+        void    push_n( It first, It last )
+        {
+            if ( first == last )
+                return;
+
+            auto bottom = new Node( *first );
+            NodeCounter top( 1, bottom );
+            for ( ++first; first != last; ++first )
+            {
+                NodeCounter node( 1, new Node( *first ) );
+                node.ptr->next = top;
+                top = node;
+            }
+
+            bottom->next = head_.load( std::memory_order_relaxed );
+            while ( ! head_.compare_exchange_weak( bottom->next, top, std::memory_order_release, std::memory_order_relaxed ) );
+        }
+
+        // Pop up to max elements (moved to out), one node at a time through pop(), return the number of elements popped
+        // The nodes cannot be detached with a single exchange then the remainder pushed back: the counter of the remainder may still be the expected
+        // head of a pop() which read it earlier (its CAS would then succeed with a stale next), and its bottom next would be rewritten while being read
+        template < typename OutputIt >
+        std::size_t     pop_n( OutputIt out, std::size_t max )
+        {
+            std::size_t result = 0;
+            for ( ; result < max; ++result )
+            {
+                auto data = pop();
+                if ( data == nullptr )
+                    break;
+                *out++ = std::move( *data );
+            }
+            return result;
+        }
+
         std::shared_ptr< T >    pop()
         {
             auto previousHead = head_.load( std::memory_order_relaxed );
@@ -0,0 +1,185 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_MULTICASTRINGBUFFER_H__
+#define __CONTAINERS_MULTICASTRINGBUFFER_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "tools/CacheInformation.h"
+
+namespace containers
+{
+    // Monotonic cursor of a producer / consumer on a MulticastRingBuffer, alone on its cache line
+    // The value is the last sequence published (producer) or processed (consumer), Initial before the first one
+    class alignas( tools::CacheLineSize ) Sequence
+    {
+    public:
+        static constexpr const std::int64_t     Initial = -1;
+
+        explicit Sequence( std::int64_t value = Initial )
+            : value_( value )
+        {
+            // NOTHING
+        }
+
+        Sequence( const Sequence& ) = delete;
+        Sequence& operator=( const Sequence& ) = delete;
+
+        std::int64_t    get() const { return value_.load( std::memory_order_acquire ); }
+        void            set( std::int64_t value ) { value_.store( value, std::memory_order_release ); } // the slots up to value can be reused / read by the dependents
+
+    private:
+        std::atomic< std::int64_t >     value_;
+    };
+
+    // Disruptor-style (LMAX) single producer multicast ring buffer: one copy of each message, read in place by every consumer
+    // - the slots are preallocated and reused: the producer claims the next sequence, fills the slot in place then publishes it (cursor)
+    // - each consumer keeps its own Sequence and reads the slots through a Barrier, which returns the highest sequence available to it:
+    //   published by the producer and, for a consumer depending on other consumers (e.g. a business logic after a journaler), already processed by all of them
+    // - the producer never overtakes the slowest consumer: it waits until all the gating sequences (the last consumers of each chain) released the slot of the previous lap
+    // - consumers process batches: one acquire load per batch of available sequences, and one release store of their sequence
+    // Waits spin then yield, as BoundedQueueMPMC
+    template < typename T, std::size_t Capacity >
+    class MulticastRingBuffer
+    {
+        static_assert( Capacity >= 2 && ( Capacity & ( Capacity - 1 ) ) == 0, "Capacity must be a power of two" );
+
+    public:
+        using value_type = T;
+
+        class Barrier
+        {
+        public:
+            // Highest sequence available ( >= sequence ), wait until there is one
+            std::int64_t    waitFor( std::int64_t sequence ) const
+            {
+                auto result = available();
+                for ( auto spin = 0; result < sequence; ++spin, result = available() )
+                    if ( spin >= 64 )
+                        std::this_thread::yield();
+                return result;
+            }
+
+            // Highest sequence available, can be lower than the one being waited for
+            std::int64_t    available() const
+            {
+                auto result = ringBuffer_.cursor_.get();
+                for ( auto dependency : dependencies_ )
+                    result = std::min( result, dependency->get() );
+                return result;
+            }
+
+        private:
+            friend class MulticastRingBuffer;
+
+            Barrier( const MulticastRingBuffer& ringBuffer, std::initializer_list< const Sequence* > dependencies )
+                : ringBuffer_( ringBuffer )
+                , dependencies_( dependencies )
+            {
+                // NOTHING
+            }
+
+            const MulticastRingBuffer&          ringBuffer_;
+            std::vector< const Sequence* >      dependencies_;
+        };
+
+        MulticastRingBuffer()
+            : slots_( new T[ Capacity ] )
+            , cursor_( Sequence::Initial )
+            , next_( 0 )
+            , cachedGating_( Sequence::Initial )
+        {
+            // NOTHING
+        }
+
+        MulticastRingBuffer( const MulticastRingBuffer& ) = delete;
+        MulticastRingBuffer& operator=( const MulticastRingBuffer& ) = delete;
+
+        // Setup, before the first claim: the producer does not overwrite a slot until sequence has processed it
+        void            addGatingSequence( const Sequence& sequence ) { gatingSequences_.push_back( &sequence ); }
+
+        // Consumers, dependencies are the sequences of the consumers which must be done with a slot first (none: only wait for the producer)
+        Barrier         newBarrier( std::initializer_list< const Sequence* > dependencies = {} ) const { return Barrier( *this, dependencies ); }
+
+        // Producer only, wait for the slot to be released by every gating sequence, return the claimed sequence
+        std::int64_t    claim()
+        {
+            const auto wrapPoint = next_ - static_cast< std::int64_t >( Capacity );
+            for ( auto spin = 0; cachedGating_ < wrapPoint; ++spin )
+            {
+                cachedGating_ = minimumGatingSequence();
+                if ( cachedGating_ < wrapPoint && spin >= 64 )
+                    std::this_thread::yield();
+            }
+            return next_++;
+        }
+
+        // Producer only, return false if the slowest consumer is a whole lap behind
+        bool            tryClaim( std::int64_t& sequence )
+        {
+            const auto wrapPoint = next_ - static_cast< std::int64_t >( Capacity );
+            if ( cachedGating_ < wrapPoint )
+            {
+                cachedGating_ = minimumGatingSequence();
+                if ( cachedGating_ < wrapPoint )
+                    return false;
+            }
+            sequence = next_++;
+            return true;
+        }
+
+        // Producer only, sequences are published in order (everything up to sequence becomes visible)
+        void            publish( std::int64_t sequence ) { cursor_.set( sequence ); }
+
+        // Producer only, claim a slot, fill it with f( T& ) and publish it
+        template < typename F >
+        void            publishWith( F&& f )
+        {
+            auto sequence = claim();
+            f( ( *this )[ sequence ] );
+            publish( sequence );
+        }
+
+        // Claimed sequence (producer) or sequence returned by a barrier and not yet released (consumer)
+        T&              operator[]( std::int64_t sequence ) { return slots_[ static_cast< std::size_t >( sequence ) & Mask ]; }
+        const T&        operator[]( std::int64_t sequence ) const { return slots_[ static_cast< std::size_t >( sequence ) & Mask ]; }
+
+        const Sequence& cursor() const { return cursor_; }
+
+        static constexpr std::size_t    capacity() { return Capacity; }
+
+    private:
+        static constexpr const std::size_t  Mask = Capacity - 1;
+
+        std::int64_t    minimumGatingSequence() const
+        {
+            auto result = next_ - 1; // nothing to wait for without consumer
+            for ( auto sequence : gatingSequences_ )
+                result = std::min( result, sequence->get() );
+            return result;
+        }
+
+    private:
+        // read only after the setup
+        alignas( tools::CacheLineSize ) const std::unique_ptr< T[] >     slots_;
+
+        // read by the consumers
+        Sequence                                                          cursor_;
+
+        // producer side
+        alignas( tools::CacheLineSize ) std::int64_t                     next_;
+        std::int64_t                                                      cachedGating_;
+        std::vector< const Sequence* >                                    gatingSequences_;
+    };
+}
+
+#endif /* ! __CONTAINERS_MULTICASTRINGBUFFER_H__ */
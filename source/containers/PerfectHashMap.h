@@ -0,0 +1,214 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_PERFECTHASHMAP_H__
+#define __CONTAINERS_PERFECTHASHMAP_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "generic/FastHash.h"
+
+namespace containers
+{
+    // Read-only map of N keys known at compile time (instrument symbols, FIX tags, message types...), built by a constexpr constructor:
+    // the table is in the binary, there is no runtime construction, and a lookup hashes the key once then probes a single slot
+    // Hash and displace: the keys are split in buckets by the hash, each bucket has its own seed, found at construction so that
+    // the keys of the bucket land in free slots ( slot = mix( hash ^ seed ) ). The largest buckets are placed first, while the table is empty
+    // - Capacity is the power of 2 above N + N / 4 (the last buckets quickly find a free slot), BucketCount is N / 2
+    // - Hash must be constexpr for the keys (generics::FastHash is for the integers and the strings), Key and Value must be literal types
+    //   with a constexpr default constructor (e.g. std::string_view, not std::string)
+    // - a duplicated key, or two keys with the same 64 bits hash, fail the construction (a compilation error when constant evaluated)
+    // Hash and KeyEqual being transparent (as the defaults), find accepts any type comparable to Key (e.g. a std::string on std::string_view keys)
+    template < typename Key, typename Value, std::size_t N, typename Hash = generics::FastHash, typename KeyEqual = std::equal_to<> >
+    class PerfectHashMap
+    {
+        static_assert( N > 0, "PerfectHashMap without key" );
+
+        static constexpr std::size_t    roundUpToPowerOfTwo( std::size_t n )
+        {
+            std::size_t result = 1;
+            while ( result < n )
+                result <<= 1;
+            return result;
+        }
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair< Key, Value >;
+
+        static constexpr const std::size_t  Capacity = roundUpToPowerOfTwo( N + N / 4 );
+        static constexpr const std::size_t  BucketCount = ( N + 1 ) / 2;
+
+        constexpr explicit PerfectHashMap( const std::array< value_type, N >& entries, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual() )
+            : slots_ {}
+            , seeds_ {}
+            , hash_( hash )
+            , equal_( equal )
+        {
+            // the keys of each bucket, contiguous (counting sort)
+            std::array< std::uint64_t, N > hashes {};
+            std::array< std::size_t, BucketCount + 1 > bucketStart {};
+            for ( std::size_t i = 0; i < N; ++i )
+            {
+                hashes[ i ] = static_cast< std::uint64_t >( hash_( entries[ i ].first ) );
+                ++bucketStart[ bucketOf( hashes[ i ] ) + 1 ];
+            }
+
+            std::size_t maxBucketSize = 0;
+            for ( std::size_t b = 0; b < BucketCount; ++b )
+            {
+                maxBucketSize = bucketStart[ b + 1 ] > maxBucketSize ? bucketStart[ b + 1 ] : maxBucketSize;
+                bucketStart[ b + 1 ] += bucketStart[ b ];
+            }
+
+            std::array< std::size_t, N > members {};
+            std::array< std::size_t, BucketCount > filled {};
+            for ( std::size_t i = 0; i < N; ++i )
+            {
+                const auto b = bucketOf( hashes[ i ] );
+                members[ bucketStart[ b ] + filled[ b ]++ ] = i;
+            }
+
+            for ( auto size = maxBucketSize; size > 0; --size )
+                for ( std::size_t b = 0; b < BucketCount; ++b )
+                    if ( bucketStart[ b + 1 ] - bucketStart[ b ] == size )
+                        placeBucket( b, entries, hashes, &members[ bucketStart[ b ] ], size );
+        }
+
+        // nullptr if key is not in the map
+        template < typename K >
+        constexpr const Value*  find( const K& key ) const
+        {
+            const auto hash = static_cast< std::uint64_t >( hash_( key ) );
+            const auto& slot = slots_[ slotOf( hash, seeds_[ bucketOf( hash ) ] ) ];
+            return slot.isUsed && equal_( slot.key, key ) ? &slot.value : nullptr;
+        }
+
+        template < typename K >
+        constexpr bool          contains( const K& key ) const { return find( key ) != nullptr; }
+
+        template < typename K >
+        constexpr std::size_t   count( const K& key ) const { return contains( key ) ? 1 : 0; }
+
+        template < typename K >
+        constexpr const Value&  at( const K& key ) const
+        {
+            const auto value = find( key );
+            if ( value == nullptr )
+                throwOutOfRange();
+            return *value;
+        }
+
+        static constexpr std::size_t    size() { return N; }
+        static constexpr bool           empty() { return false; }
+
+        // f( key, value ) for each entry, in slot order
+        template < typename F >
+        constexpr void  forEach( F&& f ) const
+        {
+            for ( const auto& slot : slots_ )
+                if ( slot.isUsed )
+                    f( slot.key, slot.value );
+        }
+
+    private:
+        static constexpr const std::uint64_t    MaxSeed = 1 << 16;
+
+        // not a std::pair, the assignment of which is not constexpr before C++20
+        struct Slot
+        {
+            Key     key;
+            Value   value;
+            bool    isUsed;
+        };
+
+        // the high bits pick the bucket (multiply-shift range reduction), the mix of all the bits and the seed picks the slot
+        static constexpr std::size_t    bucketOf( std::uint64_t hash ) { return static_cast< std::size_t >( ( ( hash >> 32 ) * BucketCount ) >> 32 ); }
+        static constexpr std::size_t    slotOf( std::uint64_t hash, std::uint64_t seed ) { return static_cast< std::size_t >( generics::details::mix( hash ^ seed, 0x9E3779B97F4A7C15ULL ) ) & ( Capacity - 1 ); }
+
+        // First seed for which the keys of the bucket land in free and distinct slots
+        constexpr void  placeBucket( std::size_t bucket, const std::array< value_type, N >& entries, const std::array< std::uint64_t, N >& hashes, const std::size_t* members, std::size_t size )
+        {
+            for ( std::size_t i = 0; i < size; ++i )
+                for ( std::size_t j = 0; j < i; ++j )
+                    if ( hashes[ members[ i ] ] == hashes[ members[ j ] ] )
+                    {
+                        if ( equal_( entries[ members[ i ] ].first, entries[ members[ j ] ].first ) )
+                            throw std::invalid_argument( "PerfectHashMap duplicated key" );
+                        throw std::invalid_argument( "PerfectHashMap keys with the same hash" );
+                    }
+
+            for ( std::uint64_t seed = 0; seed < MaxSeed; ++seed )
+            {
+                auto isPlaced = true;
+                for ( std::size_t i = 0; i < size && isPlaced; ++i )
+                {
+                    const auto slot = slotOf( hashes[ members[ i ] ], seed );
+                    isPlaced = ! slots_[ slot ].isUsed;
+                    for ( std::size_t j = 0; j < i && isPlaced; ++j )
+                        isPlaced = slotOf( hashes[ members[ j ] ], seed ) != slot;
+                }
+                if ( ! isPlaced )
+                    continue;
+
+                for ( std::size_t i = 0; i < size; ++i )
+                    slots_[ slotOf( hashes[ members[ i ] ], seed ) ] = Slot{ entries[ members[ i ] ].first, entries[ members[ i ] ].second, true };
+                seeds_[ bucket ] = seed;
+                return;
+            }
+            throw std::logic_error( "PerfectHashMap no seed places the bucket" );
+        }
+
+        static void     throwOutOfRange()
+        {
+            std::ostringstream ss;
+            ss << "PerfectHashMap key not found (size " << N << ")";
+            throw std::out_of_range( ss.str() );
+        }
+
+    private:
+        std::array< Slot, Capacity >                slots_;
+        std::array< std::uint64_t, BucketCount >    seeds_;
+        Hash                                        hash_;
+        KeyEqual                                    equal_;
+    };
+
+    namespace details
+    {
+        template < typename Key, typename Value, std::size_t N, typename Hash, typename KeyEqual, std::size_t... Is >
+        constexpr auto  makePerfectHashMap( const std::pair< Key, Value > ( &entries )[ N ], const Hash& hash, const KeyEqual& equal, std::index_sequence< Is... > )
+        {
+            return PerfectHashMap< Key, Value, N, Hash, KeyEqual >( std::array< std::pair< Key, Value >, N > { { entries[ Is ]... } }, hash, equal );
+        }
+
+        template < typename Key, std::size_t N, typename Hash, typename KeyEqual, std::size_t... Is >
+        constexpr auto  makePerfectHashIndex( const Key ( &keys )[ N ], const Hash& hash, const KeyEqual& equal, std::index_sequence< Is... > )
+        {
+            return PerfectHashMap< Key, std::size_t, N, Hash, KeyEqual >( std::array< std::pair< Key, std::size_t >, N > { { std::pair< Key, std::size_t >( keys[ Is ], Is )... } }, hash, equal );
+        }
+    }
+
+    // constexpr auto msgTypes = makePerfectHashMap< std::string_view, int >( { { "0", 0 }, { "A", 1 }, { "D", 2 } } );
+    template < typename Key, typename Value, typename Hash = generics::FastHash, typename KeyEqual = std::equal_to<>, std::size_t N >
+    constexpr auto  makePerfectHashMap( const std::pair< Key, Value > ( &entries )[ N ], const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual() )
+    {
+        return details::makePerfectHashMap( entries, hash, equal, std::make_index_sequence< N >() );
+    }
+
+    // Each key mapped to its index in keys: constexpr auto symbols = makePerfectHashIndex< std::string_view >( { "AAPL", "MSFT" } );
+    template < typename Key, typename Hash = generics::FastHash, typename KeyEqual = std::equal_to<>, std::size_t N >
+    constexpr auto  makePerfectHashIndex( const Key ( &keys )[ N ], const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual() )
+    {
+        return details::makePerfectHashIndex( keys, hash, equal, std::make_index_sequence< N >() );
+    }
+}
+
+#endif /* ! __CONTAINERS_PERFECTHASHMAP_H__ */
@@ -4,9 +4,21 @@
 //--------------------------------------------------------------------------------
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
 #include <vector>
 #include <unordered_map>
 
+#include "Colony.h"
+#include "generic/Bits.h"
+#include "generic/Typetraits.h"
+#include "threading/ThreadPool.h"
+
 namespace containers
 {
     namespace details
@@ -17,28 +29,65 @@ namespace containers
         public:
             virtual ~CollectionChunkBase() = default;
 
-            virtual void insert( Base&& x ) = 0;
+            virtual ColonyHandle    insert( Base&& x ) = 0;
+            virtual bool            erase( ColonyHandle handle ) = 0;
+            virtual Base*           get( ColonyHandle handle ) = 0;
+            virtual const Base*     get( ColonyHandle handle ) const = 0;
 
             template < typename F >
             void    for_each( F&& f )
             {
-                auto eltSize = elementSize();
-                for ( auto it = begin(), it_end = it + size() * eltSize; it != it_end; it += eltSize )
-                    f( *reinterpret_cast< Base* >( it ) );
+                for_each_in_blocks( 0, blockCount(), f );
             }
 
             template < typename F >
             void    for_each( F&& f ) const
+            {
+                for_each_in_blocks( 0, blockCount(), f );
+            }
+
+            // elements of the blocks [ first, last [, walked through the occupancy bitmap of each block
+            template < typename F >
+            void    for_each_in_blocks( std::size_t first, std::size_t last, F&& f )
             {
                 auto eltSize = elementSize();
-                for ( auto it = begin(), it_end = it + size() * eltSize; it != it_end; it += eltSize )
-                    f( *reinterpret_cast< const Base* >( it ) );
+                for ( ; first < last; ++first )
+                {
+                    auto data = blockData( first );
+                    auto bits = occupancy( first );
+                    if ( bits == ~std::uint64_t( 0 ) ) // full block: contiguous
+                        for ( auto it = data, it_end = data + ColonyBlockSize * eltSize; it != it_end; it += eltSize )
+                            f( *reinterpret_cast< Base* >( it ) );
+                    else
+                        for ( ; bits != 0; bits &= bits - 1 )
+                            f( *reinterpret_cast< Base* >( data + generics::countTrailingZeros( bits ) * eltSize ) );
+                }
+            }
+
+            template < typename F >
+            void    for_each_in_blocks( std::size_t first, std::size_t last, F&& f ) const
+            {
+                auto eltSize = elementSize();
+                for ( ; first < last; ++first )
+                {
+                    auto data = blockData( first );
+                    auto bits = occupancy( first );
+                    if ( bits == ~std::uint64_t( 0 ) ) // full block: contiguous
+                        for ( auto it = data, it_end = data + ColonyBlockSize * eltSize; it != it_end; it += eltSize )
+                            f( *reinterpret_cast< const Base* >( it ) );
+                    else
+                        for ( ; bits != 0; bits &= bits - 1 )
+                            f( *reinterpret_cast< const Base* >( data + generics::countTrailingZeros( bits ) * eltSize ) );
+                }
             }
 
-        private:
-            virtual char*           begin() = 0;
-            virtual const char*     begin() const = 0;
             virtual std::size_t     size() const = 0;
+            virtual std::size_t     blockCount() const = 0;
+
+        private:
+            virtual char*           blockData( std::size_t block ) = 0; // Base of the first slot of the block
+            virtual const char*     blockData( std::size_t block ) const = 0;
+            virtual std::uint64_t   occupancy( std::size_t block ) const = 0;
             virtual std::size_t     elementSize() const = 0;
         };
 
@@ -46,34 +95,174 @@ namespace containers
         class CollectionChunk : public CollectionChunkBase< Base >
         {
         private:
-            virtual void insert( Base&& x ) override final
+            virtual ColonyHandle insert( Base&& x ) override final
             {
-                store.emplace_back( static_cast< Derived&& >( x ) );
+                return store.emplace( static_cast< Derived&& >( x ) );
             }
 
-            virtual char* begin() override final
+            virtual bool            erase( ColonyHandle handle ) override final { return store.erase( handle ); }
+            virtual Base*           get( ColonyHandle handle ) override final { return store.get( handle ); }
+            virtual const Base*     get( ColonyHandle handle ) const override final { return store.get( handle ); }
+
+            virtual char* blockData( std::size_t block ) override final
             {
-                return reinterpret_cast< char* >( static_cast< Base* >( const_cast< Derived* >( store.data() ) ) );
+                return reinterpret_cast< char* >( static_cast< Base* >( store.element( block, 0 ) ) );
             }
 
-            virtual const char* begin() const override final
+            virtual const char* blockData( std::size_t block ) const override final
             {
-                return reinterpret_cast< const char* >( static_cast< const Base* >( store.data() ) );
+                return reinterpret_cast< const char* >( static_cast< const Base* >( store.element( block, 0 ) ) );
             }
 
+            virtual std::uint64_t   occupancy( std::size_t block ) const override final { return store.occupancy( block ); }
             virtual std::size_t     size() const override final { return store.size(); }
+            virtual std::size_t     blockCount() const override final { return store.blockCount(); }
             virtual std::size_t     elementSize() const override final { return sizeof( Derived ); }
 
-            std::vector< Derived > store;
+            Colony< Derived > store;
         };
+
+        // Split the blockCount blocks of a chunk in ranges of about grainSize elements (whole blocks), call f( firstBlock, lastBlock ) on each
+        // The storage of a block is cache aligned and spans whole cache lines: two tasks never write to the same cache line (no false sharing)
+        template < typename F >
+        void    splitBlocks( std::size_t blockCount, std::size_t grainSize, F&& f )
+        {
+            const auto blocksPerTask = std::max< std::size_t >( 1, ( grainSize + ColonyBlockSize - 1 ) / ColonyBlockSize );
+            for ( std::size_t first = 0; first < blockCount; first += blocksPerTask )
+                f( first, std::min( first + blocksPerTask, blockCount ) );
+        }
+
+        // Run the tasks of parallel_for_each on the pool and wait for all of them (then rethrow the first exception, if any)
+        template < typename Split >
+        void    runOnPool( threading::ThreadPool& pool, Split&& split )
+        {
+            std::vector< std::future< void > > tasks;
+            split( [ &pool, &tasks ] ( auto&& task ) { tasks.emplace_back( pool.enqueue( std::forward< decltype( task ) >( task ) ) ); } );
+
+            for ( auto& task : tasks )
+                task.wait(); // the tasks reference f and the chunks
+            for ( auto& task : tasks )
+                task.get();
+        }
+
+        // about 4 tasks per thread of the pool, so a slow sub-range does not leave the others idle
+        inline std::size_t  defaultGrainSize( std::size_t elementNumber, const threading::ThreadPool& pool )
+        {
+            return std::max< std::size_t >( 1'024, elementNumber / ( 4 * std::max< std::size_t >( 1, pool.size() ) ) );
+        }
     }
 
-    template < typename Base >
+    // Elements stored by value, one Colony (blocks of elements which never move) per derived type, so for_each walks contiguous objects of the same type
+    // - insert returns a Handle, valid until the element is erased, as are the pointers / references to the element; get / erase
+    //   reject a stale Handle even once its slot is reused (generation of the slot, see ColonyHandle)
+    // - erased slots are skipped by the iteration (occupancy bitmap) and reused by the next insertions of the same type
+    // Two modes:
+    // - PolymorphicCollection< Base >: open set of types, the chunk is found at runtime from typeid and for_each calls f( Base& )
+    // - PolymorphicCollection< Base, Derived... >: closed set of types, see below
+    template < typename Base, typename... Derived >
     class PolymorphicCollection
     {
+        static_assert( std::conjunction< std::is_base_of< Base, Derived >... >::value, "Type mismatch" );
+
     public:
+        struct Handle
+        {
+            std::size_t     type;       // in Derived...
+            ColonyHandle    position;
+        };
+
+        // closed set of types: a tuple of Colony< Derived >, the chunk is found at compile time and for_each calls f( Derived& ),
+        // so a call to a final override (or a generic f) is resolved statically and can be inlined
+        template < class T >
+        Handle  insert( T&& x )
+        {
+            using Type = std::decay_t< T >;
+            static_assert( generics::is_any< Type, Derived... >::value, "Type not listed in the collection" );
+
+            constexpr auto type = generics::index_of< Type, Derived... >::value;
+            return Handle{ type, std::get< type >( chunks ).emplace( std::forward< T >( x ) ) };
+        }
+
+        // false if the element was already erased
+        bool    erase( Handle handle )
+        {
+            return visit( handle.type, [ &handle ] ( auto& chunk ) { return chunk.erase( handle.position ); } );
+        }
+
+        // nullptr if the element was erased
+        Base*   get( Handle handle )
+        {
+            return visit( handle.type, [ &handle ] ( auto& chunk ) -> Base* { return chunk.get( handle.position ); } );
+        }
+
+        template < typename F >
+        void    for_each( F&& f )
+        {
+            std::apply( [ &f ] ( auto&... chunk ) { ( chunk.for_each( f ), ... ); }, chunks );
+        }
+
+        template < typename F >
+        void    for_each( F&& f ) const
+        {
+            std::apply( [ &f ] ( const auto&... chunk ) { ( chunk.for_each( f ), ... ); }, chunks );
+        }
+
+        // f( Derived& ) on every element, the blocks of the chunks are split in ranges run concurrently on pool (f must be thread safe)
+        // grainSize is the number of elements of a task (0: about 4 tasks per thread)
+        template < typename F >
+        void    parallel_for_each( threading::ThreadPool& pool, F&& f, std::size_t grainSize = 0 )
+        {
+            if ( grainSize == 0 )
+                grainSize = details::defaultGrainSize( size(), pool );
+
+            details::runOnPool( pool, [ & ] ( auto&& enqueue )
+            {
+                std::apply( [ & ] ( auto&... chunk )
+                {
+                    ( details::splitBlocks( chunk.blockCount(), grainSize, [ & ] ( std::size_t first, std::size_t last )
+                    {
+                        enqueue( [ &chunk, &f, first, last ] { chunk.for_each_in_blocks( first, last, f ); } );
+                    } ), ... );
+                }, chunks );
+            } );
+        }
+
+        template < class T >
+        const Colony< T >&  chunk() const { return std::get< generics::index_of< T, Derived... >::value >( chunks ); }
+
+        std::size_t     size() const
+        {
+            return std::apply( [] ( const auto&... chunk ) { return ( std::size_t( 0 ) + ... + chunk.size() ); }, chunks );
+        }
+
+    private:
+        // f( chunk ) on the chunk of index type
+        template < typename F >
+        auto    visit( std::size_t type, F&& f ) { return visit( type, f, std::index_sequence_for< Derived... >() ); }
+
+        template < typename F, std::size_t... Is >
+        auto    visit( std::size_t type, F& f, std::index_sequence< Is... > )
+        {
+            decltype( f( std::get< 0 >( chunks ) ) ) result {};
+            static_cast< void >( ( ( type == Is && ( result = f( std::get< Is >( chunks ) ), true ) ) || ... ) );
+            return result;
+        }
+
+        std::tuple< Colony< Derived >... > chunks;
+    };
+
+    template < typename Base >
+    class PolymorphicCollection< Base >
+    {
+    public:
+        struct Handle
+        {
+            std::type_index     type;
+            ColonyHandle        position;
+        };
+
         template < class Derived >
-        void    insert( Derived&& x )
+        Handle  insert( Derived&& x )
         {
             static_assert( std::is_base_of< Base, Derived >::value, "Type mismatch" );
 
@@ -81,7 +270,21 @@ namespace containers
             if ( ! chunk )
                 chunk.reset( new details::CollectionChunk< Derived, Base >() );
 
-            chunk->insert( std::forward< Derived >( x ) );
+            return Handle{ typeid( x ), chunk->insert( std::forward< Derived >( x ) ) };
+        }
+
+        // false if the element was already erased
+        bool    erase( const Handle& handle )
+        {
+            auto it = chunks.find( handle.type );
+            return it != chunks.end() && it->second->erase( handle.position );
+        }
+
+        // nullptr if the element was erased
+        Base*   get( const Handle& handle )
+        {
+            auto it = chunks.find( handle.type );
+            return it != chunks.end() ? it->second->get( handle.position ) : nullptr;
         }
 
         template < typename F >
@@ -98,6 +301,35 @@ namespace containers
                 const_cast< const details::CollectionChunkBase< Base >& >( *p.second ).for_each( std::forward< F >( f ) );
         }
 
+        // f( Base& ) on every element, the blocks of the chunks are split in ranges run concurrently on pool (f must be thread safe)
+        // grainSize is the number of elements of a task (0: about 4 tasks per thread)
+        template < typename F >
+        void    parallel_for_each( threading::ThreadPool& pool, F&& f, std::size_t grainSize = 0 )
+        {
+            if ( grainSize == 0 )
+                grainSize = details::defaultGrainSize( size(), pool );
+
+            details::runOnPool( pool, [ & ] ( auto&& enqueue )
+            {
+                for ( const auto& p : chunks )
+                {
+                    auto& chunk = *p.second;
+                    details::splitBlocks( chunk.blockCount(), grainSize, [ & ] ( std::size_t first, std::size_t last )
+                    {
+                        enqueue( [ &chunk, &f, first, last ] { chunk.for_each_in_blocks( first, last, f ); } );
+                    } );
+                }
+            } );
+        }
+
+        std::size_t     size() const
+        {
+            std::size_t result = 0;
+            for ( const auto& p : chunks )
+                result += p.second->size();
+            return result;
+        }
+
     private:
         std::unordered_map< std::type_index, std::unique_ptr< details::CollectionChunkBase< Base > > > chunks;
     };
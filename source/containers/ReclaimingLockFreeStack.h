@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_RECLAIMINGLOCKFREESTACK_H__
+#define __CONTAINERS_RECLAIMINGLOCKFREESTACK_H__
+
+#include <atomic>
+#include <utility>
+
+#include "threading/HazardPointers.h"
+
+namespace containers
+{
+    // Treiber stack whose popped nodes are handed to a safe memory reclamation scheme (threading::HazardPointers or threading::EpochReclamation)
+    // Compared to LockFreeStack (split reference counting):
+    // - head_ is a single pointer (no double word CAS, lock-free on every target), a protected node cannot be reclaimed nor reused so there is no ABA problem
+    // - values are stored in place and moved out by pop( T& ), there is no shared_ptr
+    template < typename T, typename Reclamation = threading::HazardPointers >
+    class ReclaimingLockFreeStack
+    {
+    public:
+        using value_type = T;
+
+        ReclaimingLockFreeStack()
+            : head_( nullptr )
+        {
+            // NOTHING
+        }
+
+        ReclaimingLockFreeStack( const ReclaimingLockFreeStack& ) = delete;
+        ReclaimingLockFreeStack& operator=( const ReclaimingLockFreeStack& ) = delete;
+
+        // No other thread can access the stack anymore
+        ~ReclaimingLockFreeStack()
+        {
+            auto node = head_.load( std::memory_order_relaxed );
+            while ( node != nullptr )
+                delete std::exchange( node, node->next );
+        }
+
+        template < typename... Args >
+        void    emplace( Args&&... args )
+        {
+            auto node = new Node( std::forward< Args >( args )... );
+            while ( ! tryPushNode( node ) )
+                ;
+        }
+
+        void    push( const T& value ) { emplace( value ); }
+        void    push( T&& value ) { emplace( std::move( value ) ); }
+
+        // Return false if the stack is empty
+        bool    pop( T& value )
+        {
+            typename Reclamation::Guard guard;
+            for ( ;; )
+            {
+                Node* node;
+                switch ( tryPopNode( guard, node ) )
+                {
+                case PopResult::Popped:
+                    value = std::move( node->value );
+                    guard.reset();
+                    Reclamation::retire( node );
+                    return true;
+                case PopResult::Empty:
+                    return false;
+                case PopResult::Contended:
+                    break;
+                }
+            }
+        }
+
+        // Approximation if called while other threads are running
+        bool    empty() const { return head_.load( std::memory_order_acquire ) == nullptr; }
+
+    protected:
+        struct Node
+        {
+            template < typename... Args >
+            explicit Node( Args&&... args )
+                : value( std::forward< Args >( args )... )
+                , next( nullptr )
+            {
+                // NOTHING
+            }
+
+            T       value;
+            Node*   next;
+        };
+
+        enum class PopResult { Popped, Empty, Contended };
+
+        // Single attempts, fail if another thread modified head_ meanwhile (used by EliminationBackoffStack to detect contention)
+        bool        tryPushNode( Node* node )
+        {
+            node->next = head_.load( std::memory_order_relaxed );
+            return head_.compare_exchange_strong( node->next, node, std::memory_order_release, std::memory_order_relaxed );
+        }
+
+        // node is unlinked on success, still protected by guard
+        PopResult   tryPopNode( typename Reclamation::Guard& guard, Node*& node )
+        {
+            node = guard.protect( head_ );
+            if ( node == nullptr )
+                return PopResult::Empty;
+
+            // next is never modified once the node is published
+            return head_.compare_exchange_strong( node, node->next, std::memory_order_acquire, std::memory_order_relaxed ) ? PopResult::Popped : PopResult::Contended;
+        }
+
+    private:
+        std::atomic< Node* >    head_;
+    };
+}
+
+#endif /* ! __CONTAINERS_RECLAIMINGLOCKFREESTACK_H__ */
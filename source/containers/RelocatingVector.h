@@ -0,0 +1,345 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_RELOCATINGVECTOR_H__
+#define __CONTAINERS_RELOCATINGVECTOR_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#include "VectorGrowthPolicy.h"
+
+namespace containers
+{
+    // A type is trivially relocatable if moving it to a new address then dropping the old bytes is equivalent to a memcpy
+    // True for the trivially copyable types, specialize it for the others (e.g. std::unique_ptr, most std::string implementations do not qualify)
+    template < typename T >
+    struct is_trivially_relocatable : std::is_trivially_copyable< T >
+    {
+        // NOTHING
+    };
+
+    namespace details
+    {
+        // Raw storage of the RelocatingVector
+        // - below MapThreshold: malloc / realloc
+        // - from MapThreshold (Linux): anonymous pages, grown with mremap: the kernel moves the page table entries, the bytes are not copied
+        //   and the old and new buffers never coexist
+        // Whether a buffer is mapped is a function of its size only, so deallocate / reallocate know how it was allocated
+        class RelocatingStorage
+        {
+        public:
+            static constexpr const std::size_t  MapThreshold = 1 << 20;
+
+            static void*    allocate( std::size_t bytes )
+            {
+                void* result = isMapped( bytes ) ? map( bytes ) : std::malloc( bytes );
+                if ( result == nullptr )
+                    throw std::bad_alloc();
+                return result;
+            }
+
+            static void     deallocate( void* p, std::size_t bytes )
+            {
+                if ( p == nullptr )
+                    return;
+                if ( isMapped( bytes ) )
+                    unmap( p, bytes );
+                else
+                    std::free( p );
+            }
+
+            // Move the first usedBytes to a buffer of newBytes, p is invalidated
+            static void*    reallocate( void* p, std::size_t oldBytes, std::size_t newBytes, std::size_t usedBytes )
+            {
+                if ( p == nullptr )
+                    return allocate( newBytes );
+
+                void* result = nullptr;
+                if ( ! isMapped( oldBytes ) && ! isMapped( newBytes ) )
+                    result = std::realloc( p, newBytes );
+#ifdef __linux__
+                else if ( isMapped( oldBytes ) && isMapped( newBytes ) )
+                {
+                    result = ::mremap( p, pageRound( oldBytes ), pageRound( newBytes ), MREMAP_MAYMOVE );
+                    if ( result == MAP_FAILED )
+                        result = nullptr;
+                }
+#endif
+                else
+                {
+                    // from the heap to the pages or back: one copy, only once per crossing of the threshold
+                    result = allocate( newBytes );
+                    std::memcpy( result, p, usedBytes );
+                    deallocate( p, oldBytes );
+                }
+
+                if ( result == nullptr )
+                    throw std::bad_alloc();
+                return result;
+            }
+
+        private:
+#ifdef __linux__
+            static bool     isMapped( std::size_t bytes ) { return bytes >= MapThreshold; }
+
+            static std::size_t  pageRound( std::size_t bytes )
+            {
+                static const auto pageSize = static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) );
+                return ( bytes + pageSize - 1 ) / pageSize * pageSize;
+            }
+
+            static void*    map( std::size_t bytes )
+            {
+                auto result = ::mmap( nullptr, pageRound( bytes ), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+                return result == MAP_FAILED ? nullptr : result;
+            }
+
+            static void     unmap( void* p, std::size_t bytes ) { ::munmap( p, pageRound( bytes ) ); }
+#else
+            // realloc only (it may still avoid the copy, depending on the allocator)
+            static bool     isMapped( std::size_t ) { return false; }
+            static void*    map( std::size_t ) { return nullptr; }
+            static void     unmap( void*, std::size_t ) {}
+#endif
+        };
+    }
+
+    // Vector whose growth relocates the trivially relocatable types with realloc / mremap instead of move constructing every element
+    // into a new buffer (which needs both buffers at once): growing a multi GB buffer neither copies it nor doubles the memory used
+    // The other types are moved element by element, as std::vector does
+    // GrowthPolicy is one of the VectorGrowthPolicy (grow is called before each insertion in a full vector, shrink after each erase), the capacity doubles otherwise
+    template < typename T, typename GrowthPolicy = VectorGrowthPolicyStd >
+    class RelocatingVector
+    {
+        static_assert( alignof( T ) <= alignof( std::max_align_t ), "Over aligned types are not supported" );
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        static constexpr const bool IsRelocatedByMemcpy = is_trivially_relocatable< T >::value;
+
+        RelocatingVector()
+            : data_( nullptr )
+            , size_( 0 )
+            , capacity_( 0 )
+        {
+            // NOTHING
+        }
+
+        explicit RelocatingVector( std::size_t count, const T& value = T() )
+            : RelocatingVector()
+        {
+            resize( count, value );
+        }
+
+        RelocatingVector( std::initializer_list< T > values )
+            : RelocatingVector()
+        {
+            reserve( values.size() );
+            for ( const auto& value : values )
+                emplace_back( value );
+        }
+
+        RelocatingVector( const RelocatingVector& other )
+            : RelocatingVector()
+        {
+            reserve( other.size_ );
+            std::uninitialized_copy( other.begin(), other.end(), data_ );
+            size_ = other.size_;
+        }
+
+        RelocatingVector( RelocatingVector&& other ) noexcept
+            : data_( std::exchange( other.data_, nullptr ) )
+            , size_( std::exchange( other.size_, 0 ) )
+            , capacity_( std::exchange( other.capacity_, 0 ) )
+        {
+            // NOTHING
+        }
+
+        RelocatingVector& operator=( RelocatingVector other ) noexcept
+        {
+            swap( other );
+            return *this;
+        }
+
+        ~RelocatingVector()
+        {
+            clear();
+            details::RelocatingStorage::deallocate( data_, capacity_ * sizeof( T ) );
+        }
+
+        void    swap( RelocatingVector& other ) noexcept
+        {
+            std::swap( data_, other.data_ );
+            std::swap( size_, other.size_ );
+            std::swap( capacity_, other.capacity_ );
+        }
+
+        std::size_t     size() const { return size_; }
+        std::size_t     capacity() const { return capacity_; }
+        bool            empty() const { return size_ == 0; }
+
+        T*          data() { return data_; }
+        const T*    data() const { return data_; }
+
+        iterator        begin() { return data_; }
+        iterator        end() { return data_ + size_; }
+        const_iterator  begin() const { return data_; }
+        const_iterator  end() const { return data_ + size_; }
+
+        T&          operator[]( std::size_t i ) { return data_[ i ]; }
+        const T&    operator[]( std::size_t i ) const { return data_[ i ]; }
+        T&          front() { return data_[ 0 ]; }
+        const T&    front() const { return data_[ 0 ]; }
+        T&          back() { return data_[ size_ - 1 ]; }
+        const T&    back() const { return data_[ size_ - 1 ]; }
+
+        T&          at( std::size_t i ) { return data_[ checkIndex( i ) ]; }
+        const T&    at( std::size_t i ) const { return data_[ checkIndex( i ) ]; }
+
+        template < typename... Args >
+        T&  emplace_back( Args&&... args )
+        {
+            if ( size_ != capacity_ )
+                return constructBack( std::forward< Args >( args )... );
+
+            // args may refer to an element (push_back( v[ 0 ] )): the value is built before the growth releases the old buffer
+            T value( std::forward< Args >( args )... );
+            GrowthPolicy::grow( *this );
+            if ( size_ == capacity_ )
+                relocate( std::max< std::size_t >( 2 * capacity_, InitialCapacity ) );
+            return constructBack( std::move( value ) );
+        }
+
+        void    push_back( const T& value ) { emplace_back( value ); }
+        void    push_back( T&& value ) { emplace_back( std::move( value ) ); }
+
+        void    pop_back()
+        {
+            data_[ --size_ ].~T();
+            GrowthPolicy::shrink( *this );
+        }
+
+        void    reserve( std::size_t count )
+        {
+            if ( count > capacity_ )
+                relocate( count );
+        }
+
+        void    resize( std::size_t count, const T& value = T() )
+        {
+            if ( count < size_ )
+            {
+                std::destroy( data_ + count, data_ + size_ );
+                size_ = count;
+                return;
+            }
+
+            if ( count <= capacity_ )
+            {
+                std::uninitialized_fill( data_ + size_, data_ + count, value );
+                size_ = count;
+                return;
+            }
+
+            // value may be an element (resize( n, v.back() )), copied before the growth releases the old buffer
+            const T copy( value );
+            relocate( count );
+            std::uninitialized_fill( data_ + size_, data_ + count, copy );
+            size_ = count;
+        }
+
+        void    shrink_to_fit()
+        {
+            if ( size_ < capacity_ )
+                relocate( size_ );
+        }
+
+        // keep the capacity, as std::vector
+        void    clear()
+        {
+            std::destroy( data_, data_ + size_ );
+            size_ = 0;
+        }
+
+    private:
+        static constexpr const std::size_t  InitialCapacity = std::max< std::size_t >( 1, 64 / sizeof( T ) );
+
+        std::size_t     checkIndex( std::size_t i ) const
+        {
+            if ( i >= size_ )
+                throw std::out_of_range( "RelocatingVector index out of range" );
+            return i;
+        }
+
+        template < typename... Args >
+        T&  constructBack( Args&&... args )
+        {
+            auto result = ::new ( static_cast< void* >( data_ + size_ ) ) T( std::forward< Args >( args )... );
+            ++size_;
+            return *result;
+        }
+
+        void    relocate( std::size_t newCapacity )
+        {
+            if ( newCapacity == 0 )
+            {
+                details::RelocatingStorage::deallocate( data_, capacity_ * sizeof( T ) );
+                data_ = nullptr;
+                capacity_ = 0;
+                return;
+            }
+
+            if constexpr ( IsRelocatedByMemcpy )
+                data_ = static_cast< T* >( details::RelocatingStorage::reallocate( data_, capacity_ * sizeof( T ), newCapacity * sizeof( T ), size_ * sizeof( T ) ) );
+            else
+            {
+                auto newData = static_cast< T* >( details::RelocatingStorage::allocate( newCapacity * sizeof( T ) ) );
+                std::size_t constructed = 0;
+                try
+                {
+                    // copied if the move can throw, so the vector is left untouched on exception (as std::vector)
+                    for ( ; constructed < size_; ++constructed )
+                        ::new ( static_cast< void* >( newData + constructed ) ) T( std::move_if_noexcept( data_[ constructed ] ) );
+                }
+                catch ( ... )
+                {
+                    std::destroy( newData, newData + constructed );
+                    details::RelocatingStorage::deallocate( newData, newCapacity * sizeof( T ) );
+                    throw;
+                }
+                std::destroy( data_, data_ + size_ );
+                details::RelocatingStorage::deallocate( data_, capacity_ * sizeof( T ) );
+                data_ = newData;
+            }
+            capacity_ = newCapacity;
+        }
+
+    private:
+        T*              data_;
+        std::size_t     size_;
+        std::size_t     capacity_;
+    };
+}
+
+#endif /* ! __CONTAINERS_RELOCATINGVECTOR_H__ */
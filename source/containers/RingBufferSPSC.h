@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_RINGBUFFERSPSC_H__
+#define __CONTAINERS_RINGBUFFERSPSC_H__
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "tools/CacheInformation.h"
+
+namespace containers
+{
+    // Bounded Single Producer Single Consumer queue (fixed capacity, no allocation after construction)
+    // - head_ (written by the consumer) and tail_ (written by the producer) live on separate cache lines
+    // - each side keeps a cached copy of the opposite index, which is only refreshed when the queue looks full (producer) / empty (consumer),
+    //   so in steady state each side only touches the cache line of the other one once per "lap" instead of once per element
+    // - publication is done with a release store of the index, observed with an acquire load (no seq_cst / full fence needed with only two threads)
+    // - indexes grow monotonically, slot is index & Mask (Capacity must be a power of two, so the wrap around of size_t is harmless)
+    template < typename T, std::size_t Capacity >
+    class RingBufferSPSC
+    {
+        static_assert( Capacity >= 2 && ( Capacity & ( Capacity - 1 ) ) == 0, "Capacity must be a power of two" );
+
+    public:
+        using value_type = T;
+
+        RingBufferSPSC()
+            : slots_( new Slot[ Capacity ] )
+            , tail_( 0 )
+            , cachedHead_( 0 )
+            , head_( 0 )
+            , cachedTail_( 0 )
+        {
+            // NOTHING
+        }
+
+        RingBufferSPSC( const RingBufferSPSC& ) = delete;
+        RingBufferSPSC& operator=( const RingBufferSPSC& ) = delete;
+
+        ~RingBufferSPSC()
+        {
+            for ( auto head = head_.load( std::memory_order_relaxed ), tail = tail_.load( std::memory_order_relaxed ); head != tail; ++head )
+                element( head ).~T();
+        }
+
+        // Producer only, construct the element in place, return false if the queue is full
+        template < typename... Args >
+        bool    emplace( Args&&... args )
+        {
+            const auto tail = tail_.load( std::memory_order_relaxed );
+            if ( tail - cachedHead_ == Capacity )
+            {
+                cachedHead_ = head_.load( std::memory_order_acquire ); // the consumer is done with the slot
+                if ( tail - cachedHead_ == Capacity )
+                    return false;
+            }
+
+            new ( &slots_[ tail & Mask ] ) T( std::forward< Args >( args )... );
+            tail_.store( tail + 1, std::memory_order_release ); // publish the element
+            return true;
+        }
+
+        bool    try_push( const T& value ) { return emplace( value ); }
+        bool    try_push( T&& value ) { return emplace( std::move( value ) ); }
+
+        // Consumer only, return false if the queue is empty
+        bool    try_pop( T& value )
+        {
+            const auto head = head_.load( std::memory_order_relaxed );
+            if ( head == cachedTail_ )
+            {
+                cachedTail_ = tail_.load( std::memory_order_acquire ); // the producer is done with the slot
+                if ( head == cachedTail_ )
+                    return false;
+            }
+
+            auto& e = element( head );
+            value = std::move( e );
+            e.~T();
+            head_.store( head + 1, std::memory_order_release ); // give back the slot
+            return true;
+        }
+
+        // Producer only, push as many elements as possible from [first, last) with a single publication, return the number of elements pushed
+        template < typename It >
+        std::size_t     push_n( It first, It last )
+        {
+            const auto tail = tail_.load( std::memory_order_relaxed );
+            cachedHead_ = head_.load( std::memory_order_acquire );
+
+            std::size_t result = 0;
+            for ( const auto available = Capacity - ( tail - cachedHead_ ); result < available && first != last; ++result, ++first )
+                new ( &slots_[ ( tail + result ) & Mask ] ) T( *first );
+
+            tail_.store( tail + result, std::memory_order_release );
+            return result;
+        }
+
+        // Consumer only, pop up to max elements (moved to out) and give back their slots with a single store, return the number of elements popped
+        template < typename OutputIt >
+        std::size_t     pop_n( OutputIt out, std::size_t max )
+        {
+            const auto head = head_.load( std::memory_order_relaxed );
+            cachedTail_ = tail_.load( std::memory_order_acquire );
+
+            std::size_t result = 0;
+            for ( const auto available = cachedTail_ - head; result < available && result < max; ++result )
+            {
+                auto& e = element( head + result );
+                *out++ = std::move( e );
+                e.~T();
+            }
+
+            head_.store( head + result, std::memory_order_release );
+            return result;
+        }
+
+        // Approximation if called while the other side is running
+        bool            empty() const { return size() == 0; }
+        std::size_t     size() const { return tail_.load( std::memory_order_acquire ) - head_.load( std::memory_order_acquire ); }
+
+        static constexpr std::size_t    capacity() { return Capacity; }
+
+    private:
+        using Slot = std::aligned_storage_t< sizeof( T ), alignof( T ) >;
+        static constexpr const std::size_t  Mask = Capacity - 1;
+
+        T&  element( std::size_t index ) { return *std::launder( reinterpret_cast< T* >( &slots_[ index & Mask ] ) ); }
+
+    private:
+        // read only after construction, shared by both sides
+        alignas( tools::CacheLineSize ) const std::unique_ptr< Slot[] >   slots_;
+
+        // producer side
+        alignas( tools::CacheLineSize ) std::atomic< std::size_t >        tail_;
+        std::size_t                                                         cachedHead_;
+
+        // consumer side
+        alignas( tools::CacheLineSize ) std::atomic< std::size_t >        head_;
+        std::size_t                                                         cachedTail_;
+    };
+}
+
+#endif /* ! __CONTAINERS_RINGBUFFERSPSC_H__ */
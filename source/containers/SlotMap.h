@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_SLOTMAP_H__
+#define __CONTAINERS_SLOTMAP_H__
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace containers
+{
+    // Handle on a SlotMap value: the slot plus the generation of the slot when the value was inserted
+    struct SlotMapHandle
+    {
+        std::uint32_t   index;
+        std::uint32_t   generation;
+
+        bool    operator==( const SlotMapHandle& other ) const { return index == other.index && generation == other.generation; }
+        bool    operator!=( const SlotMapHandle& other ) const { return ! ( *this == other ); }
+    };
+
+    // Dynamic sparse set with stable generational handles, values densely packed for the iteration
+    // - values_ is dense (no hole, no order): erase moves the last value into the hole (swap-with-last), insert appends
+    // - slots_ is the indirection of the handles: the position of the value in values_ while alive, the next free slot once erased
+    // - erase bumps the generation of the slot: a stale handle (erased value, slot reused since) is rejected instead of reading another value
+    // insert / erase / find are O(1), no allocation once the capacity is reached (erased slots are reused, most recently freed first)
+    template < typename T >
+    class SlotMap
+    {
+    public:
+        using value_type = T;
+        using handle_type = SlotMapHandle;
+        using iterator = typename std::vector< T >::iterator;
+        using const_iterator = typename std::vector< T >::const_iterator;
+
+        SlotMap()
+            : freeHead_( NoSlot )
+        {
+            // NOTHING
+        }
+
+        template < typename... Args >
+        SlotMapHandle   emplace( Args&&... args )
+        {
+            values_.emplace_back( std::forward< Args >( args )... );
+
+            std::uint32_t index;
+            if ( freeHead_ != NoSlot )
+            {
+                index = freeHead_;
+                freeHead_ = slots_[ index ].position;
+            }
+            else
+            {
+                if ( slots_.size() == NoSlot )
+                {
+                    values_.pop_back();
+                    throw std::length_error( "SlotMap is full" );
+                }
+                index = static_cast< std::uint32_t >( slots_.size() );
+                slots_.push_back( Slot{ 0, 0 } );
+            }
+
+            slots_[ index ].position = static_cast< std::uint32_t >( values_.size() - 1 );
+            valueSlots_.push_back( index );
+            return SlotMapHandle{ index, slots_[ index ].generation };
+        }
+
+        SlotMapHandle   insert( const T& value ) { return emplace( value ); }
+        SlotMapHandle   insert( T&& value ) { return emplace( std::move( value ) ); }
+
+        // false if the handle is stale
+        bool    erase( SlotMapHandle handle )
+        {
+            if ( ! contains( handle ) )
+                return false;
+
+            auto& slot = slots_[ handle.index ];
+            const auto last = static_cast< std::uint32_t >( values_.size() - 1 );
+            if ( slot.position != last )
+            {
+                values_[ slot.position ] = std::move( values_[ last ] );
+                valueSlots_[ slot.position ] = valueSlots_[ last ];
+                slots_[ valueSlots_[ last ] ].position = slot.position;
+            }
+            values_.pop_back();
+            valueSlots_.pop_back();
+
+            ++slot.generation;
+            slot.position = freeHead_;
+            freeHead_ = handle.index;
+            return true;
+        }
+
+        bool    contains( SlotMapHandle handle ) const
+        {
+            return handle.index < slots_.size() && slots_[ handle.index ].generation == handle.generation;
+        }
+
+        // nullptr if the handle is stale, valid until the next insert / erase
+        T*          find( SlotMapHandle handle ) { return contains( handle ) ? &values_[ slots_[ handle.index ].position ] : nullptr; }
+        const T*    find( SlotMapHandle handle ) const { return contains( handle ) ? &values_[ slots_[ handle.index ].position ] : nullptr; }
+
+        T&          operator[]( SlotMapHandle handle ) { return values_[ getPositionChecked( handle ) ]; }
+        const T&    operator[]( SlotMapHandle handle ) const { return values_[ getPositionChecked( handle ) ]; }
+
+        // Handle of the value at position in the iteration order (e.g. to erase while iterating)
+        SlotMapHandle   handleAt( std::size_t position ) const
+        {
+            const auto index = valueSlots_[ position ];
+            return SlotMapHandle{ index, slots_[ index ].generation };
+        }
+
+        // Dense iteration, in no particular order
+        iterator        begin() { return values_.begin(); }
+        iterator        end() { return values_.end(); }
+        const_iterator  begin() const { return values_.begin(); }
+        const_iterator  end() const { return values_.end(); }
+
+        std::size_t     size() const { return values_.size(); }
+        bool            empty() const { return values_.empty(); }
+
+        void    reserve( std::size_t count )
+        {
+            values_.reserve( count );
+            valueSlots_.reserve( count );
+            slots_.reserve( count );
+        }
+
+        // Every handle becomes stale, the slots are kept for reuse
+        void    clear()
+        {
+            for ( auto index : valueSlots_ )
+            {
+                ++slots_[ index ].generation;
+                slots_[ index ].position = freeHead_;
+                freeHead_ = index;
+            }
+            values_.clear();
+            valueSlots_.clear();
+        }
+
+    private:
+        static constexpr const std::uint32_t    NoSlot = std::numeric_limits< std::uint32_t >::max();
+
+        struct Slot
+        {
+            std::uint32_t   position;   // in values_ if alive, next free slot otherwise
+            std::uint32_t   generation;
+        };
+
+        std::uint32_t   getPositionChecked( SlotMapHandle handle ) const
+        {
+            if ( contains( handle ) )
+                return slots_[ handle.index ].position;
+
+            std::ostringstream ss;
+            ss << "SlotMap handle (" << handle.index << ", " << handle.generation << ") is stale";
+            throw std::out_of_range( ss.str() );
+        }
+
+    private:
+        std::vector< T >                values_;
+        std::vector< std::uint32_t >    valueSlots_;    // slot of each value, to fix the slot of the value moved by an erase
+        std::vector< Slot >             slots_;
+        std::uint32_t                   freeHead_;
+    };
+}
+
+#endif /* ! __CONTAINERS_SLOTMAP_H__ */
@@ -0,0 +1,355 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_SOAVECTOR_H__
+#define __CONTAINERS_SOAVECTOR_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Span.h"
+#include "tools/AlignedAllocator.h"
+
+namespace containers
+{
+    // Proxy on the element of a SoAVector, behaves as a tuple of references on its fields
+    // - get< I >() is the field I, structured bindings bind to the fields: auto [ x, y, z ] = soa[ i ]; x += 1; writes into the vector
+    // - assigning a tuple (or another element) writes every field, the conversion to the tuple reads every field
+    // As any reference, it is invalidated by the reallocation of the vector
+    template < bool IsConst, typename... Fields >
+    class SoAReference
+    {
+    public:
+        using value_type = std::tuple< Fields... >;
+
+        template < std::size_t I >
+        using field_reference = std::conditional_t< IsConst, const std::tuple_element_t< I, value_type >&, std::tuple_element_t< I, value_type >& >;
+
+        explicit SoAReference( std::tuple< std::conditional_t< IsConst, const Fields*, Fields* >... > fields )
+            : fields_( fields )
+        {
+            // NOTHING
+        }
+
+        // a non const reference is a const reference too
+        template < bool OtherIsConst, typename = std::enable_if_t< IsConst && ! OtherIsConst > >
+        SoAReference( const SoAReference< OtherIsConst, Fields... >& other )
+            : fields_( other.fields_ )
+        {
+            // NOTHING
+        }
+
+        SoAReference( const SoAReference& ) = default;
+
+        template < std::size_t I >
+        field_reference< I >    get() const { return *std::get< I >( fields_ ); }
+
+        operator value_type() const { return toValue( std::index_sequence_for< Fields... >() ); }
+
+        // Copy the fields, the proxy is not rebound
+        SoAReference&   operator=( const SoAReference& other ) { return assign( other ); }
+
+        template < bool OtherIsConst >
+        SoAReference&   operator=( const SoAReference< OtherIsConst, Fields... >& other ) { return assign( other ); }
+
+        SoAReference&   operator=( const value_type& value )
+        {
+            assignFields( value, std::index_sequence_for< Fields... >() );
+            return *this;
+        }
+
+        bool    operator==( const value_type& value ) const { return value_type( *this ) == value; }
+        bool    operator!=( const value_type& value ) const { return ! ( *this == value ); }
+
+    private:
+        template < bool, typename... >
+        friend class SoAReference;
+
+        template < std::size_t... Is >
+        value_type  toValue( std::index_sequence< Is... > ) const { return value_type( get< Is >()... ); }
+
+        template < typename Value, std::size_t... Is >
+        void    assignFields( const Value& value, std::index_sequence< Is... > )
+        {
+            using std::get;
+            ( ( *std::get< Is >( fields_ ) = get< Is >( value ) ), ... );
+        }
+
+        template < bool OtherIsConst >
+        SoAReference&   assign( const SoAReference< OtherIsConst, Fields... >& other )
+        {
+            static_assert( ! IsConst, "Assignment through a const reference" );
+            assignFields( value_type( other ), std::index_sequence_for< Fields... >() ); // copied first, other may alias *this
+            return *this;
+        }
+
+    private:
+        std::tuple< std::conditional_t< IsConst, const Fields*, Fields* >... >  fields_;
+    };
+
+    namespace details
+    {
+        // Random access iterator over the elements of a container of proxies (a const Vector for the const_iterator), dereferenced as a Reference
+        template < typename Vector, typename Reference >
+        class ProxyIterator
+        {
+        public:
+            using reference = Reference;
+            using value_type = typename Reference::value_type;
+            using pointer = void;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::random_access_iterator_tag;
+
+            ProxyIterator() = default;
+
+            ProxyIterator( Vector& vector, std::size_t index )
+                : vector_( &vector )
+                , index_( index )
+            {
+                // NOTHING
+            }
+
+            // an iterator is a const_iterator too
+            template < typename OtherReference, typename V = Vector, typename = std::enable_if_t< std::is_const< V >::value > >
+            ProxyIterator( const ProxyIterator< std::remove_const_t< Vector >, OtherReference >& other )
+                : vector_( other.vector_ )
+                , index_( other.index_ )
+            {
+                // NOTHING
+            }
+
+            reference   operator*() const { return ( *vector_ )[ index_ ]; }
+            reference   operator[]( difference_type n ) const { return ( *vector_ )[ index_ + n ]; }
+
+            ProxyIterator&  operator++() { ++index_; return *this; }
+            ProxyIterator&  operator--() { --index_; return *this; }
+            ProxyIterator   operator++( int ) { auto result = *this; ++index_; return result; }
+            ProxyIterator   operator--( int ) { auto result = *this; --index_; return result; }
+            ProxyIterator&  operator+=( difference_type n ) { index_ += n; return *this; }
+            ProxyIterator&  operator-=( difference_type n ) { index_ -= n; return *this; }
+            ProxyIterator   operator+( difference_type n ) const { return ProxyIterator( *vector_, index_ + n ); }
+            ProxyIterator   operator-( difference_type n ) const { return ProxyIterator( *vector_, index_ - n ); }
+
+            difference_type     operator-( const ProxyIterator& other ) const { return static_cast< difference_type >( index_ - other.index_ ); }
+
+            bool    operator==( const ProxyIterator& other ) const { return index_ == other.index_; }
+            bool    operator!=( const ProxyIterator& other ) const { return index_ != other.index_; }
+            bool    operator<( const ProxyIterator& other ) const { return index_ < other.index_; }
+            bool    operator>( const ProxyIterator& other ) const { return index_ > other.index_; }
+            bool    operator<=( const ProxyIterator& other ) const { return index_ <= other.index_; }
+            bool    operator>=( const ProxyIterator& other ) const { return index_ >= other.index_; }
+
+            friend ProxyIterator    operator+( difference_type n, const ProxyIterator& it ) { return it + n; }
+
+            std::size_t     index() const { return index_; }
+
+        private:
+            template < typename, typename >
+            friend class ProxyIterator;
+
+            Vector*         vector_ = nullptr;
+            std::size_t     index_ = 0;
+        };
+    }
+
+    // Vector of tuples stored as a Structure-Of-Arrays: each field in its own contiguous array (see CacheTestSuite AOSvsSOABenchmark)
+    // - a loop reading a few fields only fetches the cache lines of those fields, and a field is a plain array for the SIMD loops: field< I >()
+    // - soa[ i ] is a proxy on the fields of the element i, so the code using the elements reads as with an Array-Of-Structures
+    // - the arrays are resized together and start on a cache line (aligned loads)
+    // Every insertion / erase is applied to all the arrays: prefer the AoS when the elements are mostly accessed as a whole, or at random
+    template < typename... Fields >
+    class SoAVector
+    {
+        static_assert( sizeof...( Fields ) > 0, "SoAVector without field" );
+
+        template < typename T >
+        using Array = std::vector< T, tools::AlignedAllocator< T > >;
+
+    public:
+        using value_type = std::tuple< Fields... >;
+        using reference = SoAReference< false, Fields... >;
+        using const_reference = SoAReference< true, Fields... >;
+
+        template < std::size_t I >
+        using field_type = std::tuple_element_t< I, value_type >;
+
+        static constexpr const std::size_t  FieldCount = sizeof...( Fields );
+
+        using iterator = details::ProxyIterator< SoAVector, reference >;
+        using const_iterator = details::ProxyIterator< const SoAVector, const_reference >;
+
+        SoAVector() = default;
+
+        // count value initialized elements
+        explicit SoAVector( std::size_t count )
+        {
+            resize( count );
+        }
+
+        std::size_t     size() const { return std::get< 0 >( arrays_ ).size(); }
+        bool            empty() const { return size() == 0; }
+        std::size_t     capacity() const { return std::apply( [] ( const auto&... arrays ) { return std::min( { arrays.capacity()... } ); }, arrays_ ); }
+
+        // Contiguous array of the field I, invalidated by the reallocations
+        template < std::size_t I >
+        Span< field_type< I > >         field() { return Span< field_type< I > >( std::get< I >( arrays_ ).data(), size() ); }
+
+        template < std::size_t I >
+        Span< const field_type< I > >   field() const { return Span< const field_type< I > >( std::get< I >( arrays_ ).data(), size() ); }
+
+        reference           operator[]( std::size_t i ) { return makeReference< reference >( *this, i, Indexes() ); }
+        const_reference     operator[]( std::size_t i ) const { return makeReference< const_reference >( *this, i, Indexes() ); }
+
+        reference           at( std::size_t i ) { return operator[]( checkIndex( i ) ); }
+        const_reference     at( std::size_t i ) const { return operator[]( checkIndex( i ) ); }
+
+        reference           front() { return operator[]( 0 ); }
+        const_reference     front() const { return operator[]( 0 ); }
+        reference           back() { return operator[]( size() - 1 ); }
+        const_reference     back() const { return operator[]( size() - 1 ); }
+
+        iterator        begin() { return iterator( *this, 0 ); }
+        iterator        end() { return iterator( *this, size() ); }
+        const_iterator  begin() const { return const_iterator( *this, 0 ); }
+        const_iterator  end() const { return const_iterator( *this, size() ); }
+        const_iterator  cbegin() const { return begin(); }
+        const_iterator  cend() const { return end(); }
+
+        // One value per field
+        template < typename... Args >
+        reference   emplace_back( Args&&... args )
+        {
+            static_assert( sizeof...( Args ) == FieldCount, "One value per field is expected" );
+
+            if ( size() != capacity() )
+                return pushBack( std::forward< Args >( args )... );
+
+            // args may be fields of an element (emplace_back( soa.front().get< 0 >(), ... )): they are read before the reallocation
+            value_type value( std::forward< Args >( args )... );
+            reserve( std::max< std::size_t >( 2 * size(), 16 ) ); // the arrays then grow together
+            return std::apply( [ this ] ( auto&... fields ) { return pushBack( std::move( fields )... ); }, value );
+        }
+
+        void    push_back( const value_type& value ) { std::apply( [ this ] ( const auto&... fields ) { emplace_back( fields... ); }, value ); }
+        void    push_back( value_type&& value ) { std::apply( [ this ] ( auto&&... fields ) { emplace_back( std::move( fields )... ); }, value ); }
+
+        void    pop_back()
+        {
+            forEachArray( [] ( auto& array ) { array.pop_back(); } );
+        }
+
+        // Keep the order of the elements (the following elements of every array are shifted)
+        iterator    erase( const_iterator first, const_iterator last )
+        {
+            const auto firstIndex = static_cast< std::ptrdiff_t >( first.index() );
+            const auto lastIndex = static_cast< std::ptrdiff_t >( last.index() );
+            forEachArray( [ firstIndex, lastIndex ] ( auto& array ) { array.erase( array.begin() + firstIndex, array.begin() + lastIndex ); } );
+            return iterator( *this, first.index() );
+        }
+
+        iterator    erase( const_iterator position ) { return erase( position, position + 1 ); }
+
+        void    reserve( std::size_t count )
+        {
+            forEachArray( [ count ] ( auto& array ) { array.reserve( count ); } );
+        }
+
+        void    resize( std::size_t count )
+        {
+            forEachArray( [ count ] ( auto& array ) { array.resize( count ); } );
+        }
+
+        void    clear()
+        {
+            forEachArray( [] ( auto& array ) { array.clear(); } );
+        }
+
+        void    swap( SoAVector& other ) noexcept
+        {
+            arrays_.swap( other.arrays_ );
+        }
+
+    private:
+        using Indexes = std::index_sequence_for< Fields... >;
+
+        template < typename Reference, typename Self, std::size_t... Is >
+        static Reference    makeReference( Self& self, std::size_t i, std::index_sequence< Is... > )
+        {
+            return Reference( std::make_tuple( std::get< Is >( self.arrays_ ).data() + i... ) );
+        }
+
+        template < typename F >
+        void    forEachArray( F f )
+        {
+            std::apply( [ &f ] ( auto&... arrays ) { ( f( arrays ), ... ); }, arrays_ );
+        }
+
+        // Every array has room for one more element
+        template < typename... Args >
+        reference   pushBack( Args&&... args )
+        {
+            std::size_t pushed = 0;
+            try
+            {
+                pushFields( pushed, Indexes(), std::forward< Args >( args )... );
+            }
+            catch ( ... )
+            {
+                popFields( pushed, Indexes() ); // all the arrays keep the same size
+                throw;
+            }
+            return back();
+        }
+
+        template < std::size_t... Is, typename... Args >
+        void    pushFields( std::size_t& pushed, std::index_sequence< Is... >, Args&&... args )
+        {
+            ( ( std::get< Is >( arrays_ ).emplace_back( std::forward< Args >( args ) ), ++pushed ), ... );
+        }
+
+        template < std::size_t... Is >
+        void    popFields( std::size_t pushed, std::index_sequence< Is... > )
+        {
+            ( ( Is < pushed ? std::get< Is >( arrays_ ).pop_back() : void() ), ... );
+        }
+
+        std::size_t     checkIndex( std::size_t i ) const
+        {
+            if ( i < size() )
+                return i;
+
+            std::ostringstream ss;
+            ss << "SoAVector index " << i << " is out of range (size " << size() << ")";
+            throw std::out_of_range( ss.str() );
+        }
+
+    private:
+        std::tuple< Array< Fields >... >    arrays_;
+    };
+}
+
+// Structured bindings on the proxies: auto [ x, y ] = soa[ i ];
+namespace std
+{
+    template < bool IsConst, typename... Fields >
+    struct tuple_size< containers::SoAReference< IsConst, Fields... > > : std::integral_constant< std::size_t, sizeof...( Fields ) >
+    {
+        // NOTHING
+    };
+
+    template < std::size_t I, bool IsConst, typename... Fields >
+    struct tuple_element< I, containers::SoAReference< IsConst, Fields... > >
+    {
+        using type = typename containers::SoAReference< IsConst, Fields... >::template field_reference< I >;
+    };
+}
+
+#endif /* ! __CONTAINERS_SOAVECTOR_H__ */
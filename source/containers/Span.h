@@ -0,0 +1,49 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __CONTAINERS_SPAN_H__
+#define __CONTAINERS_SPAN_H__
+
+#include <cstddef>
+
+namespace containers
+{
+    // Non owning view on count contiguous T (as std::span), valid as long as the viewed storage is not reallocated
+    template < typename T >
+    class Span
+    {
+    public:
+        using value_type = T;
+        using iterator = T*;
+
+        Span()
+            : data_( nullptr )
+            , size_( 0 )
+        {
+            // NOTHING
+        }
+
+        Span( T* data, std::size_t size )
+            : data_( data )
+            , size_( size )
+        {
+            // NOTHING
+        }
+
+        T*              data() const { return data_; }
+        std::size_t     size() const { return size_; }
+        bool            empty() const { return size_ == 0; }
+
+        iterator    begin() const { return data_; }
+        iterator    end() const { return data_ + size_; }
+
+        T&          operator[]( std::size_t i ) const { return data_[ i ]; }
+
+    private:
+        T*              data_;
+        std::size_t     size_;
+    };
+}
+
+#endif /* ! __CONTAINERS_SPAN_H__ */
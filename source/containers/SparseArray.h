@@ -5,12 +5,35 @@
 #ifndef __SPARSEARRAY_H__
 #define __SPARSEARRAY_H__
 
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "HierarchicalBitset.h"
 #include "VectorGrowthPolicy.h"
+#include "generic/Bits.h"
 
 namespace containers
 {
+    // Values of the initialized indexes only, stored contiguously in index order
+    // The position of an index in the vector is its rank (number of initialized indexes below it), answered in O(1):
+    // - the bits are the 64 bits words of a HierarchicalBitset, grouped in blocks of 8 words (one cache line), grouped in superblocks of 128 blocks
+    // - each superblock stores the number of bits set before it, each block the number of bits set before it within its superblock,
+    //   each word the number of bits set before it within its block (16 bits counts below the superblock)
+    // - rank = superblock count + block count + word count + popcount of the bits below the index in its word
+    // Initializing / resetting an index updates the counts of the following words in the block, of the following blocks in the superblock
+    // and of the following superblocks: at most 7 + 127 + N / 65536 counts (~800 for N = 50M)
+    // The initialized indexes are visited in order through the summary levels of the bitset (empty words are skipped), alongside the vector
+    // Large N (e.g. an order id space) are meant to be allocated on the heap: the bits and counts are held by value
     template < typename T, std::size_t N, typename GrowthPolicy = VectorGrowthPolicyStd >
     class SparseArray
     {
@@ -18,16 +41,97 @@ namespace containers
         using value_type = T;
         static const size_t     MAX_SIZE = N;
 
+        // Forward iterator over the initialized indexes, dereferenced as a ( index, value ) pair
+        template < bool IsConst >
+        class Iterator
+        {
+        public:
+            using Array = std::conditional_t< IsConst, const SparseArray, SparseArray >;
+            using reference = std::pair< std::size_t, std::conditional_t< IsConst, const T&, T& > >;
+            using value_type = reference;
+            using pointer = void;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+
+            Iterator() = default;
+
+            reference   operator*() const
+            {
+                return reference( index_, array_->vector_[ position_ ] );
+            }
+
+            Iterator&   operator++()
+            {
+                index_ = array_->bits_.findNext( index_ );
+                ++position_;
+                return *this;
+            }
+
+            Iterator    operator++( int )
+            {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            bool    operator==( const Iterator& other ) const { return index_ == other.index_; }
+            bool    operator!=( const Iterator& other ) const { return ! ( *this == other ); }
+
+        private:
+            friend class SparseArray;
+
+            Iterator( Array& array, std::size_t index )
+                : array_( &array )
+                , index_( index )
+                , position_( 0 )
+            {
+                // NOTHING
+            }
+
+            Array*          array_ = nullptr;
+            std::size_t     index_ = N;
+            std::size_t     position_ = 0; // in vector_
+        };
+
+        using iterator = Iterator< false >;
+        using const_iterator = Iterator< true >;
+
         SparseArray() = default;
 
+        iterator        begin() { return iterator( *this, bits_.findFirst() ); }
+        iterator        end() { return iterator( *this, N ); }
+        const_iterator  begin() const { return const_iterator( *this, bits_.findFirst() ); }
+        const_iterator  end() const { return const_iterator( *this, N ); }
+        const_iterator  cbegin() const { return begin(); }
+        const_iterator  cend() const { return end(); }
+
+        // f( index, value ) on each initialized index, in order
+        template < typename F >
+        void    for_each( F&& f ) { forEach( *this, f ); }
+
+        template < typename F >
+        void    for_each( F&& f ) const { forEach( *this, f ); }
+
         std::size_t     size() const
         {
-            return bitset_.count();
+            return vector_.size();
+        }
+
+        bool    empty() const
+        {
+            return bits_.none();
         }
 
+        // Every access by index goes through it: throw std::out_of_range if index >= N
         bool    isInitialized( std::size_t index ) const
         {
-            return bitset_.test( index );
+            if ( index >= N )
+            {
+                std::ostringstream ss;
+                ss << "SparseArray index " << index << " is out of range (size " << N << ")";
+                throw std::out_of_range( ss.str() );
+            }
+            return bits_.test( index );
         }
 
         const T&    operator[]( std::size_t index ) const
@@ -40,7 +144,7 @@ namespace containers
             if ( isInitialized( index ) )
                 return vector_[ getVectorIndex( index ) ];
 
-            bitset_.set( index );
+            setBit( index );
             GrowthPolicy::grow( vector_ );
             return *vector_.insert( std::begin( vector_ ) + static_cast< std::size_t >( getVectorIndex( index ) ), T() );
         }
@@ -57,7 +161,10 @@ namespace containers
 
         void    reset()
         {
-            bitset_.reset();
+            bits_.reset();
+            superblockRanks_.fill( 0 );
+            blockRanks_.fill( 0 );
+            wordRanks_.fill( 0 );
             GrowthPolicy::clear( vector_ );
         }
 
@@ -68,14 +175,33 @@ namespace containers
 
             vector_.erase( std::begin( vector_ ) + getVectorIndex( i ) );
             GrowthPolicy::shrink( vector_ );
-            bitset_.reset( i );
+            resetBit( i );
         }
 
+        // Only the initialized indexes are looked up in indexToReset, the kept values are compacted in one pass then the counts are rebuilt
         void    resetIndex( const std::bitset< N >& indexToReset )
         {
-            for ( std::size_t i = 0; i < N; ++i )
-                if ( indexToReset.test( i ) && isInitialized( i ) )
-                    reset( i );
+            std::size_t read = 0;
+            std::size_t write = 0;
+            bits_.forEach( [ & ] ( std::size_t index )
+            {
+                if ( indexToReset.test( index ) )
+                    bits_.reset( index );
+                else
+                {
+                    if ( read != write )
+                        vector_[ write ] = std::move( vector_[ read ] );
+                    ++write;
+                }
+                ++read;
+            } );
+
+            if ( write == read )
+                return;
+
+            vector_.erase( std::begin( vector_ ) + write, std::end( vector_ ) );
+            GrowthPolicy::shrink( vector_ );
+            rebuildRanks();
         }
 
         void    reserve( std::size_t count )
@@ -84,13 +210,81 @@ namespace containers
         }
 
     private:
+        static constexpr const std::size_t  WordBits = HierarchicalBitset< N >::WordBits;
+        static constexpr const std::size_t  WordsPerBlock = 8;
+        static constexpr const std::size_t  BlocksPerSuperblock = 128;
+        static constexpr const std::size_t  WordCount = HierarchicalBitset< N >::wordCount();
+        static constexpr const std::size_t  BlockCount = ( WordCount + WordsPerBlock - 1 ) / WordsPerBlock;
+        static constexpr const std::size_t  SuperblockCount = ( BlockCount + BlocksPerSuperblock - 1 ) / BlocksPerSuperblock;
+
+        static_assert( WordsPerBlock * WordBits <= std::numeric_limits< std::uint16_t >::max(), "Word ranks do not fit" );
+        static_assert( ( BlocksPerSuperblock - 1 ) * WordsPerBlock * WordBits <= std::numeric_limits< std::uint16_t >::max(), "Block ranks do not fit" );
+        static_assert( N <= std::numeric_limits< std::uint32_t >::max(), "Superblock ranks do not fit" );
+
         std::size_t     getVectorIndex( std::size_t index ) const
         {
-            std::size_t result = 0;
-            for ( std::size_t i = 0; i < index; ++i )
-                if ( isInitialized( i ) )
-                    ++result;
-            return result;
+            const auto word = index / WordBits;
+            const auto block = word / WordsPerBlock;
+            return superblockRanks_[ block / BlocksPerSuperblock ] + blockRanks_[ block ] + wordRanks_[ word ]
+                 + generics::popcount( bits_.word( word ) & generics::lowerBitsMask( static_cast< unsigned >( index % WordBits ) ) );
+        }
+
+        void    setBit( std::size_t index )
+        {
+            bits_.set( index );
+            updateRanks< 1 >( index / WordBits );
+        }
+
+        void    resetBit( std::size_t index )
+        {
+            bits_.reset( index );
+            updateRanks< -1 >( index / WordBits );
+        }
+
+        void    rebuildRanks()
+        {
+            std::uint32_t total = 0;
+            std::uint32_t inSuperblock = 0; // 65536 once a superblock is full
+            for ( std::size_t block = 0; block < BlockCount; ++block )
+            {
+                if ( block % BlocksPerSuperblock == 0 )
+                {
+                    total += inSuperblock;
+                    inSuperblock = 0;
+                    superblockRanks_[ block / BlocksPerSuperblock ] = total;
+                }
+
+                blockRanks_[ block ] = inSuperblock;
+                std::uint16_t inBlock = 0;
+                for ( auto word = block * WordsPerBlock; word < std::min( ( block + 1 ) * WordsPerBlock, WordCount ); ++word )
+                {
+                    wordRanks_[ word ] = inBlock;
+                    inBlock = static_cast< std::uint16_t >( inBlock + generics::popcount( bits_.word( word ) ) );
+                }
+                inSuperblock += inBlock;
+            }
+        }
+
+        template < typename Self, typename F >
+        static void     forEach( Self& self, F& f )
+        {
+            std::size_t position = 0;
+            self.bits_.forEach( [ & ] ( std::size_t index ) { f( index, self.vector_[ position++ ] ); } );
+        }
+
+        template < int Delta >
+        void    updateRanks( std::size_t word )
+        {
+            const auto block = word / WordsPerBlock;
+            const auto blockEnd = std::min( ( block + 1 ) * WordsPerBlock, WordCount );
+            for ( auto i = word + 1; i < blockEnd; ++i )
+                wordRanks_[ i ] = static_cast< std::uint16_t >( wordRanks_[ i ] + Delta );
+            const auto superblock = block / BlocksPerSuperblock;
+            const auto superblockEnd = std::min( ( superblock + 1 ) * BlocksPerSuperblock, BlockCount );
+            for ( auto i = block + 1; i < superblockEnd; ++i )
+                blockRanks_[ i ] = static_cast< std::uint16_t >( blockRanks_[ i ] + Delta );
+            for ( auto i = superblock + 1; i < SuperblockCount; ++i )
+                superblockRanks_[ i ] = static_cast< std::uint32_t >( superblockRanks_[ i ] + Delta );
         }
 
         std::size_t     getIndexChecked( std::size_t i ) const
@@ -105,7 +299,7 @@ namespace containers
 
         void    move( std::size_t from, std::size_t to )
         {
-            if ( ! bitset_[ from ] )
+            if ( ! isInitialized( from ) )
                 return;
 
             T value = vector_[ getVectorIndex( from ) ];
@@ -114,8 +308,11 @@ namespace containers
         }
 
     private:
-        std::bitset< N >    bitset_;
-        std::vector< T >    vector_;
+        HierarchicalBitset< N >                         bits_;
+        std::array< std::uint32_t, SuperblockCount >    superblockRanks_ {};
+        std::array< std::uint16_t, BlockCount >         blockRanks_ {};
+        std::array< std::uint16_t, WordCount >          wordRanks_ {};
+        std::vector< T >                                vector_;
     };
 }
 
@@ -5,42 +5,44 @@
 #ifndef __VECTORGROWTHPOLICY_H__
 #define __VECTORGROWTHPOLICY_H__
 
+#include <algorithm>
 #include <vector>
 
 namespace containers
 {
+    // The policies apply to any vector with size / capacity / reserve / swap and copy construction (std::vector, RelocatingVector)
     struct VectorGrowthPolicyStd
     {
-        template < typename T > static void grow( std::vector< T >& ) {}
-        template < typename T > static void shrink( std::vector< T >& ) {}
-        template < typename T > static void clear( std::vector< T >& v )
+        template < typename Vector > static void grow( Vector& ) {}
+        template < typename Vector > static void shrink( Vector& ) {}
+        template < typename Vector > static void clear( Vector& v )
         {
             // instead of doing clear() then shrink_to_fit() (Requests the container to reduce its capacity to fit its size)
-            return std::vector< T >().swap( v );
+            return Vector().swap( v );
         }
     };
 
     template < std::size_t SIZE_T_INCREMENT, std::size_t SIZE_T_MAX_SIZE >
     struct VectorGrowthPolicyIncremental
     {
-        template < typename T > static void grow( std::vector< T >& v )
+        template < typename Vector > static void grow( Vector& v )
         {
             auto size = v.size();
             if ( v.capacity() == size )
                 v.reserve( std::min( size + SIZE_T_INCREMENT, SIZE_T_MAX_SIZE ) );
         }
 
-        template < typename T > static void shrink( std::vector< T >& v )
+        template < typename Vector > static void shrink( Vector& v )
         {
-            if ( v.size() - v.capacity() < SIZE_T_INCREMENT )
-                std::vector< T >( v ).swap( v );
+            if ( v.capacity() - v.size() >= SIZE_T_INCREMENT )
+                Vector( v ).swap( v );
         }
 
-        template < typename T > static void clear( std::vector< T >& v )
+        template < typename Vector > static void clear( Vector& v )
         {
             static_assert( SIZE_T_INCREMENT > 0 );
             static_assert( SIZE_T_INCREMENT <= SIZE_T_MAX_SIZE );
-            return std::vector< T >().swap( v );
+            return Vector().swap( v );
         }
     };
 
@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __GENERICS_BITS_H__
+#define __GENERICS_BITS_H__
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+namespace generics
+{
+    // Number of bits set (popcnt when the target has it)
+    inline unsigned popcount( std::uint64_t word )
+    {
+#ifdef _MSC_VER
+        return static_cast< unsigned >( __popcnt64( word ) );
+#else
+        return static_cast< unsigned >( __builtin_popcountll( word ) );
+#endif
+    }
+
+    // Index of the lowest bit set (tzcnt / bsf), word must not be 0
+    inline unsigned countTrailingZeros( std::uint64_t word )
+    {
+#ifdef _MSC_VER
+        unsigned long result;
+        _BitScanForward64( &result, word );
+        return static_cast< unsigned >( result );
+#else
+        return static_cast< unsigned >( __builtin_ctzll( word ) );
+#endif
+    }
+
+    // Number of zeros above the highest bit set (lzcnt / bsr), word must not be 0
+    inline unsigned countLeadingZeros( std::uint64_t word )
+    {
+#ifdef _MSC_VER
+        unsigned long result;
+        _BitScanReverse64( &result, word );
+        return 63 - static_cast< unsigned >( result );
+#else
+        return static_cast< unsigned >( __builtin_clzll( word ) );
+#endif
+    }
+
+    // Mask of the bits strictly below bit (bit in [0, 64[)
+    inline std::uint64_t lowerBitsMask( unsigned bit )
+    {
+        return ( std::uint64_t( 1 ) << bit ) - 1;
+    }
+}
+
+#endif /* !__GENERICS_BITS_H__ */
@@ -0,0 +1,340 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __GENERICS_FASTHASH_H__
+#define __GENERICS_FASTHASH_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+# include <emmintrin.h>
+# define GENERICS_FASTHASH_SSE2
+#endif
+
+// True while constant evaluated: the constexpr paths then avoid the intrinsics and memcpy
+// (without the builtin, they are always taken: same hashes, slower at runtime)
+#if defined( __GNUC__ ) || defined( __clang__ ) || ( defined( _MSC_VER ) && _MSC_VER >= 1925 )
+# define GENERICS_FASTHASH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+# define GENERICS_FASTHASH_CONSTANT_EVALUATED() true
+#endif
+
+// Non cryptographic hash family, every output bit depends on every input bit (unlike std::hash, the identity for the integers on libstdc++ / libc++)
+// - integers: two folded 64 x 64 -> 128 bits multiplications (wyhash mixer)
+// - up to BulkThreshold bytes: wyhash, 16 bytes per multiplication (three independent chains above 48 bytes)
+// - longer: XXH3 accumulation, 8 lanes of 64 bits updated by 32 x 32 -> 64 bits multiplications, with SSE2 when available
+//   (the scalar and SSE2 paths give the same hash), merged with the folded multiplications
+// The hashes are the same on every little endian platform, but not stable across versions: do not persist them
+// hashInteger and hashString (up to BulkThreshold bytes) are constexpr, with the same result as at runtime: a table built at compile time
+// (see containers::PerfectHashMap) is probed with the runtime hash
+namespace generics
+{
+    namespace details
+    {
+        // 64 x 64 -> 128 bits multiplication, low and high halves
+        constexpr void  multiply128( std::uint64_t& a, std::uint64_t& b )
+        {
+#if defined( _MSC_VER ) && ! defined( __clang__ )
+# if defined( _M_X64 )
+            if ( ! GENERICS_FASTHASH_CONSTANT_EVALUATED() )
+            {
+                a = _umul128( a, b, &b );
+                return;
+            }
+# endif
+            // four 32 x 32 -> 64 bits products (the sum of the cross terms cannot overflow)
+            const auto lowLow = ( a & 0xFFFFFFFF ) * ( b & 0xFFFFFFFF );
+            const auto highLow = ( a >> 32 ) * ( b & 0xFFFFFFFF );
+            const auto lowHigh = ( a & 0xFFFFFFFF ) * ( b >> 32 );
+            const auto highHigh = ( a >> 32 ) * ( b >> 32 );
+            const auto cross = ( lowLow >> 32 ) + ( highLow & 0xFFFFFFFF ) + lowHigh;
+            a = ( cross << 32 ) | ( lowLow & 0xFFFFFFFF );
+            b = highHigh + ( highLow >> 32 ) + ( cross >> 32 );
+#else
+            const auto product = static_cast< unsigned __int128 >( a ) * b;
+            a = static_cast< std::uint64_t >( product );
+            b = static_cast< std::uint64_t >( product >> 64 );
+#endif
+        }
+
+        // Xor of the halves of a * b
+        constexpr std::uint64_t     mix( std::uint64_t a, std::uint64_t b )
+        {
+            multiply128( a, b );
+            return a ^ b;
+        }
+
+        // Little endian read of Size bytes (Byte is char or unsigned char), a single load at runtime
+        template < std::size_t Size, typename Byte >
+        constexpr std::uint64_t     read( const Byte* p )
+        {
+            std::uint64_t result = 0;
+            if ( GENERICS_FASTHASH_CONSTANT_EVALUATED() )
+            {
+                for ( std::size_t i = 0; i < Size; ++i )
+                    result |= std::uint64_t( static_cast< unsigned char >( p[ i ] ) ) << ( 8 * i );
+            }
+            else
+                std::memcpy( &result, p, Size );
+            return result;
+        }
+
+        template < typename Byte >
+        constexpr std::uint64_t     read64( const Byte* p ) { return read< 8 >( p ); }
+
+        template < typename Byte >
+        constexpr std::uint64_t     read32( const Byte* p ) { return read< 4 >( p ); }
+
+        // 1 to 3 bytes: the first, middle and last ones
+        template < typename Byte >
+        constexpr std::uint64_t     read3( const Byte* p, std::size_t size )
+        {
+            return ( std::uint64_t( static_cast< unsigned char >( p[ 0 ] ) ) << 16 ) | ( std::uint64_t( static_cast< unsigned char >( p[ size >> 1 ] ) ) << 8 ) | static_cast< unsigned char >( p[ size - 1 ] );
+        }
+
+        static constexpr const std::uint64_t    Secret[ 4 ] = { 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL };
+
+        static constexpr const std::size_t      BulkThreshold = 256;
+        static constexpr const std::size_t      StripeSize = 64;    // bytes accumulated at once (one per lane)
+        static constexpr const std::size_t      BulkSecretSize = 192;
+        static constexpr const std::size_t      StripesPerBlock = ( BulkSecretSize - StripeSize ) / 8;
+        static constexpr const std::uint64_t    Prime32 = 0x9E3779B1U;
+
+        // Key bytes of the bulk path (splitmix64 sequence)
+        constexpr std::array< unsigned char, BulkSecretSize >   makeBulkSecret()
+        {
+            std::array< unsigned char, BulkSecretSize > result {};
+            std::uint64_t state = 0x2545F4914F6CDD1DULL;
+            for ( std::size_t i = 0; i < BulkSecretSize; i += 8 )
+            {
+                auto z = ( state += 0x9E3779B97F4A7C15ULL );
+                z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+                z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+                z ^= z >> 31;
+                for ( std::size_t byte = 0; byte < 8; ++byte )
+                    result[ i + byte ] = static_cast< unsigned char >( z >> ( 8 * byte ) );
+            }
+            return result;
+        }
+
+        static constexpr const std::array< unsigned char, BulkSecretSize >  BulkSecret = makeBulkSecret();
+
+        // Every lane accumulates the product of the halves of its data ^ key, and the data of its neighbour lane (so no byte is lost by the product)
+        inline void     accumulateScalar( std::uint64_t* lanes, const unsigned char* stripe, const unsigned char* key )
+        {
+            for ( std::size_t i = 0; i < 8; ++i )
+            {
+                const auto data = read64( stripe + 8 * i );
+                const auto dataKey = data ^ read64( key + 8 * i );
+                lanes[ i ^ 1 ] += data;
+                lanes[ i ] += ( dataKey & 0xFFFFFFFF ) * ( dataKey >> 32 );
+            }
+        }
+
+        // Between the blocks, so the high bits of the lanes feed the next products
+        inline void     scrambleScalar( std::uint64_t* lanes, const unsigned char* key )
+        {
+            for ( std::size_t i = 0; i < 8; ++i )
+                lanes[ i ] = ( lanes[ i ] ^ ( lanes[ i ] >> 47 ) ^ read64( key + 8 * i ) ) * Prime32;
+        }
+
+#ifdef GENERICS_FASTHASH_SSE2
+        // Two lanes per register, lanes must be 16 bytes aligned
+        inline void     accumulateSse2( std::uint64_t* lanes, const unsigned char* stripe, const unsigned char* key )
+        {
+            auto accumulators = reinterpret_cast< __m128i* >( lanes );
+            for ( std::size_t i = 0; i < StripeSize / 16; ++i )
+            {
+                const auto data = _mm_loadu_si128( reinterpret_cast< const __m128i* >( stripe ) + i );
+                const auto dataKey = _mm_xor_si128( data, _mm_loadu_si128( reinterpret_cast< const __m128i* >( key ) + i ) );
+                const auto product = _mm_mul_epu32( dataKey, _mm_shuffle_epi32( dataKey, _MM_SHUFFLE( 0, 3, 0, 1 ) ) ); // low half * high half of each lane
+                const auto swapped = _mm_shuffle_epi32( data, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+                accumulators[ i ] = _mm_add_epi64( accumulators[ i ], _mm_add_epi64( product, swapped ) );
+            }
+        }
+
+        inline void     scrambleSse2( std::uint64_t* lanes, const unsigned char* key )
+        {
+            auto accumulators = reinterpret_cast< __m128i* >( lanes );
+            const auto prime = _mm_set1_epi32( static_cast< int >( Prime32 ) );
+            for ( std::size_t i = 0; i < StripeSize / 16; ++i )
+            {
+                auto value = _mm_xor_si128( accumulators[ i ], _mm_srli_epi64( accumulators[ i ], 47 ) );
+                value = _mm_xor_si128( value, _mm_loadu_si128( reinterpret_cast< const __m128i* >( key ) + i ) );
+                // 64 x 32 bits multiplication = low * prime + ( high * prime ) << 32
+                const auto low = _mm_mul_epu32( value, prime );
+                const auto high = _mm_mul_epu32( _mm_srli_epi64( value, 32 ), prime );
+                accumulators[ i ] = _mm_add_epi64( low, _mm_slli_epi64( high, 32 ) );
+            }
+        }
+#endif
+
+        inline std::uint64_t    avalanche( std::uint64_t h )
+        {
+            h ^= h >> 37;
+            h *= 0x165667919E3779F9ULL;
+            return h ^ ( h >> 32 );
+        }
+
+        // More than StripeSize bytes: blocks of StripesPerBlock stripes, then the last stripes, the very last one overlapping the previous one
+        template < void ( *Accumulate )( std::uint64_t*, const unsigned char*, const unsigned char* ), void ( *Scramble )( std::uint64_t*, const unsigned char* ) >
+        std::uint64_t   hashLong( const unsigned char* p, std::size_t size, std::uint64_t seed )
+        {
+            alignas( 16 ) std::uint64_t lanes[ 8 ] = { Prime32, Secret[ 0 ], Secret[ 1 ], Secret[ 2 ], Secret[ 3 ], 0x85EBCA77U, 0x27D4EB2F165667C5ULL, 0xC2B2AE3DU };
+            const auto secret = BulkSecret.data();
+
+            const auto blockSize = StripeSize * StripesPerBlock;
+            const auto blockCount = ( size - 1 ) / blockSize;
+            for ( std::size_t block = 0; block < blockCount; ++block, p += blockSize )
+            {
+                for ( std::size_t stripe = 0; stripe < StripesPerBlock; ++stripe )
+                    Accumulate( lanes, p + stripe * StripeSize, secret + stripe * 8 );
+                Scramble( lanes, secret + BulkSecretSize - StripeSize );
+            }
+
+            const auto remaining = size - blockCount * blockSize;
+            const auto stripeCount = ( remaining - 1 ) / StripeSize;
+            for ( std::size_t stripe = 0; stripe < stripeCount; ++stripe )
+                Accumulate( lanes, p + stripe * StripeSize, secret + stripe * 8 );
+            Accumulate( lanes, p + remaining - StripeSize, secret + BulkSecretSize - StripeSize - 7 );
+
+            auto result = size * 0x9E3779B185EBCA87ULL ^ seed;
+            for ( std::size_t i = 0; i < 4; ++i )
+                result += mix( lanes[ 2 * i ] ^ read64( secret + 11 + 16 * i ), lanes[ 2 * i + 1 ] ^ read64( secret + 19 + 16 * i ) );
+            return avalanche( result );
+        }
+
+        inline std::uint64_t    hashLong( const unsigned char* p, std::size_t size, std::uint64_t seed )
+        {
+#ifdef GENERICS_FASTHASH_SSE2
+            return hashLong< accumulateSse2, scrambleSse2 >( p, size, seed );
+#else
+            return hashLong< accumulateScalar, scrambleScalar >( p, size, seed );
+#endif
+        }
+
+        // Up to BulkThreshold bytes
+        template < typename Byte >
+        constexpr std::uint64_t     hashShort( const Byte* p, std::size_t size, std::uint64_t seed )
+        {
+            seed ^= mix( seed ^ Secret[ 0 ], Secret[ 1 ] );
+            std::uint64_t a = 0;
+            std::uint64_t b = 0;
+            if ( size <= 16 )
+            {
+                if ( size >= 4 )
+                {
+                    // two overlapping 8 bytes words from 4 bytes reads
+                    const auto quarter = ( size >> 3 ) << 2;
+                    a = ( read32( p ) << 32 ) | read32( p + quarter );
+                    b = ( read32( p + size - 4 ) << 32 ) | read32( p + size - 4 - quarter );
+                }
+                else if ( size > 0 )
+                    a = read3( p, size );
+            }
+            else
+            {
+                auto remaining = size;
+                if ( remaining > 48 )
+                {
+                    auto seed1 = seed;
+                    auto seed2 = seed;
+                    do
+                    {
+                        seed = mix( read64( p ) ^ Secret[ 1 ], read64( p + 8 ) ^ seed );
+                        seed1 = mix( read64( p + 16 ) ^ Secret[ 2 ], read64( p + 24 ) ^ seed1 );
+                        seed2 = mix( read64( p + 32 ) ^ Secret[ 3 ], read64( p + 40 ) ^ seed2 );
+                        p += 48;
+                        remaining -= 48;
+                    } while ( remaining > 48 );
+                    seed ^= seed1 ^ seed2;
+                }
+                for ( ; remaining > 16; remaining -= 16, p += 16 )
+                    seed = mix( read64( p ) ^ Secret[ 1 ], read64( p + 8 ) ^ seed );
+                a = read64( p + remaining - 16 );
+                b = read64( p + remaining - 8 );
+            }
+
+            a ^= Secret[ 1 ];
+            b ^= seed;
+            multiply128( a, b );
+            return mix( a ^ Secret[ 0 ] ^ size, b ^ Secret[ 1 ] );
+        }
+    }
+
+    constexpr std::uint64_t     hashInteger( std::uint64_t value, std::uint64_t seed = 0 )
+    {
+        return details::mix( details::mix( value ^ details::Secret[ 0 ], seed ^ details::Secret[ 1 ] ), details::Secret[ 2 ] );
+    }
+
+    inline std::uint64_t    hashBytes( const void* data, std::size_t size, std::uint64_t seed = 0 )
+    {
+        const auto p = static_cast< const unsigned char* >( data );
+        return size > details::BulkThreshold ? details::hashLong( p, size, seed ) : details::hashShort( p, size, seed );
+    }
+
+    // hashBytes( s.data(), s.size(), seed ), constexpr up to BulkThreshold bytes (the bulk path is only taken at runtime)
+    constexpr std::uint64_t     hashString( std::string_view s, std::uint64_t seed = 0 )
+    {
+        return s.size() > details::BulkThreshold ? hashBytes( s.data(), s.size(), seed ) : details::hashShort( s.data(), s.size(), seed );
+    }
+
+    // Hash functor for the hash tables (e.g. the default Hash of containers::FlatHashMap)
+    // - the integers, enums and pointers are hashed by value, the floating points by value too (0. == -0.)
+    // - std::string, std::string_view and the C strings are hashed as bytes, to the same value: it is transparent (heterogeneous lookups)
+    // - any other type is hashed by std::hash, then mixed
+    // is_avalanching tells the tables the hash needs no further mixing
+    // The integers, enums and strings (up to BulkThreshold bytes) are hashed at compile time too
+    struct FastHash
+    {
+        using is_transparent = void;
+        using is_avalanching = void;
+
+        template < typename T, std::enable_if_t< std::is_integral< T >::value || std::is_enum< T >::value, int > = 0 >
+        constexpr std::size_t   operator()( T value ) const { return static_cast< std::size_t >( hashInteger( static_cast< std::uint64_t >( value ) ) ); }
+
+        template < typename T, std::enable_if_t< std::is_floating_point< T >::value, int > = 0 >
+        std::size_t     operator()( T value ) const
+        {
+            if ( value == 0 )
+                value = 0; // -0.
+            std::uint64_t bits = 0;
+            std::memcpy( &bits, &value, sizeof( T ) < sizeof( bits ) ? sizeof( T ) : sizeof( bits ) );
+            return static_cast< std::size_t >( hashInteger( bits ) );
+        }
+
+        template < typename T >
+        std::size_t     operator()( T* p ) const { return static_cast< std::size_t >( hashInteger( reinterpret_cast< std::uintptr_t >( p ) ) ); }
+
+        constexpr std::size_t   operator()( std::string_view s ) const { return static_cast< std::size_t >( hashString( s ) ); }
+        constexpr std::size_t   operator()( const char* s ) const { return operator()( std::string_view( s ) ); }
+        constexpr std::size_t   operator()( char* s ) const { return operator()( std::string_view( s ) ); }
+
+        template < typename T, std::enable_if_t< ! std::is_arithmetic< T >::value && ! std::is_enum< T >::value && ! std::is_convertible< const T&, std::string_view >::value, int > = 0 >
+        std::size_t     operator()( const T& value ) const { return static_cast< std::size_t >( hashInteger( std::hash< T >()( value ) ) ); }
+    };
+
+    // Hasher of hashCombineGeneric: generics::hashCombineGeneric< FastHasher >( a, b, c )
+    class FastHasher
+    {
+    public:
+        template < typename T >
+        static constexpr size_t hash( const T& t )
+        {
+            return FastHash()( t );
+        }
+    };
+}
+
+#endif /* ! __GENERICS_FASTHASH_H__ */
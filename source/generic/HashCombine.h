@@ -10,7 +10,7 @@
 namespace generics
 {
     // the Hash128to64 function from Google's cityhash (available under the MIT License).
-    inline uint64_t Hash128to64(const uint64_t upper, const uint64_t lower)
+    constexpr uint64_t Hash128to64(const uint64_t upper, const uint64_t lower)
     {
         // Murmur-inspired hashing.
         const uint64_t kMul = 0x9ddfea08eb382d69ULL;
@@ -25,14 +25,15 @@ namespace generics
     }
 
     template <class Hash>
-    size_t  hashCombineGeneric()
+    constexpr size_t  hashCombineGeneric()
     {
         return 0;
     }
 
     // based on facebook folly
+    // constexpr when Hash::hash is (e.g. FastHasher on integers and strings)
     template <class Hash, typename T, typename ...Ts>
-    size_t  hashCombineGeneric(const T& t, const Ts&... ts)
+    constexpr size_t  hashCombineGeneric(const T& t, const Ts&... ts)
     {
         size_t seed = Hash::hash(t);
         if (sizeof...(ts) == 0)
@@ -5,7 +5,7 @@
 #ifndef __GENERICS_TUPLEPRINTER_H__
 #define __GENERICS_TUPLEPRINTER_H__
 
-#include "TypeTraits.h"
+#include "Typetraits.h"
 
 namespace generics
 {
@@ -48,6 +48,15 @@ namespace generics
     struct is_any< T, First, Rest... > : std::integral_constant< bool, std::is_same< T, First >::value || is_any< T, Rest... >::value >
     {};
 
+    // Position of T in Ts (compile error if T is not one of them)
+    template < typename T, typename First, typename... Rest >
+    struct index_of : std::integral_constant< std::size_t, 1 + index_of< T, Rest... >::value >
+    {};
+
+    template < typename T, typename... Rest >
+    struct index_of< T, T, Rest... > : std::integral_constant< std::size_t, 0 >
+    {};
+
     template < typename ENUM_TYPE >
     constexpr auto enum_cast( ENUM_TYPE v )
     {
@@ -19,7 +19,10 @@
 
 #include "generic/Typetraits.h"
 #include "generic/TuplePrinter.h"
+#include "containers/AoSoAVector.h"
 #include "containers/PolymorphicCollection.h"
+#include "containers/SoAVector.h"
+#include "threading/Combinable.h"
 #include "tools/Benchmark.h"
 
 using namespace tools;
@@ -285,28 +288,44 @@ namespace
     struct Particle { int x, y, z, dx, dy, dz; };
     using AOSParticle = std::vector< Particle >;
 
-    struct SOAParticle
-    {
-        SOAParticle( size_t n ) : x( n ), y( n ), z( n ), dx( n ), dy( n ), dz( n ) {}
-        std::vector<int> x, y, z, dx, dy, dz;
-    };
+    // one array per field
+    using SOAParticle = containers::SoAVector< int, int, int, int, int, int >;
+    enum ParticleField { X, Y, Z, DX, DY, DZ };
 }
 
 BOOST_AUTO_TEST_CASE( AOSvsSOABenchmark )
 {
     auto test = [] ( auto n )
     {
-        double aosT, soaT;
-        std::tie( aosT, soaT ) = benchmark( n,
+        double aosT, soaT, soaProxyT;
+        std::tie( aosT, soaT, soaProxyT ) = benchmark( n,
                                             // 64 / ( 6 / 3 ) / sizeof( int ) = 8 useful values per fetch average (6 / 3 :  only need x, y, z)
                                             [ aos = AOSParticle( n ), n ] { auto res = 0; for ( auto i = 0; i < n; ++i ) res += aos[ i ].x + aos[ i ].y + aos[ i ].z; return res; },
 
-                                            // 64 / sizeof( int ) = 16 useful values per fetch
-                                            [ soa = SOAParticle( n ), n ] { auto res = 0; for ( auto i = 0; i < n; ++i ) res += soa.x[ i ] + soa.y[ i ] + soa.z[ i ]; return res; } );
+                                            // 64 / sizeof( int ) = 16 useful values per fetch, the loop over the field arrays is vectorized
+                                            [ soa = SOAParticle( n ), n ]
+                                            {
+                                                auto res = 0;
+                                                auto x = soa.field< X >(), y = soa.field< Y >(), z = soa.field< Z >();
+                                                for ( auto i = 0; i < n; ++i ) res += x[ i ] + y[ i ] + z[ i ];
+                                                return res;
+                                            },
+
+                                            // same layout through the proxies, which only hold a pointer per field: should be on par with soa
+                                            [ soa = SOAParticle( n ) ]
+                                            {
+                                                auto res = 0;
+                                                for ( auto p : soa )
+                                                {
+                                                    auto [ x, y, z, dx, dy, dz ] = p;
+                                                    res += x + y + z;
+                                                }
+                                                return res;
+                                            } );
 
         BOOST_CHECK( aosT > soaT );
     };
-    run_test< int >( "aos;soa;", test, 4'096, 16'384, 100'000, 1'000'000, 10'000'000 );
+    run_test< int >( "aos;soa;soa_proxy;", test, 4'096, 16'384, 100'000, 1'000'000, 10'000'000 );
 }
 
 namespace
@@ -314,11 +333,10 @@ namespace
     struct CompactParticle { int x, y, z; };
     using AOSCompactParticle = std::vector< CompactParticle >;
 
-    struct SOACompactParticle
-    {
-        SOACompactParticle( size_t n ) : x( n ), y( n ), z( n ) {}
-        std::vector<int> x, y, z;
-    };
+    using SOACompactParticle = containers::SoAVector< int, int, int >;
+
+    // blocks of one SIMD register per field (e.g. 4 x, 4 y, 4 z with SSE)
+    using AOSOACompactParticle = containers::AoSoAVector< containers::SimdWidth< int >, int, int, int >;
 }
 
 BOOST_AUTO_TEST_CASE( CompactAOSvsSOABenchmark )
@@ -329,24 +347,39 @@ BOOST_AUTO_TEST_CASE( CompactAOSvsSOABenchmark )
         // SOA is faster (diminishingly as n grows), because CPU can prefetch x, y, z in parallel
         // (e.g. big picture: aos need to prefetch (stale) every N bytes, but soa only need to prefetch every N * 3 (the is more expensive, but less than the stale depending of the cache layer))
 
-        double aosT, soaT;
-        std::tie( aosT, soaT ) = benchmark( n,
+        double aosT, soaT, aosoaT;
+        std::tie( aosT, soaT, aosoaT ) = benchmark( n,
                                             [ aos = AOSCompactParticle( n ), n ] { auto res = 0; for ( auto i = 0; i < n; ++i ) res += aos[ i ].x + aos[ i ].y + aos[ i ].z; return res; },
-                                            [ soa = SOACompactParticle( n ), n ] { auto res = 0; for ( auto i = 0; i < n; ++i ) res += soa.x[ i ] + soa.y[ i ] + soa.z[ i ]; return res; } );
+                                            [ soa = SOACompactParticle( n ), n ] { auto res = 0; auto x = soa.field< X >(), y = soa.field< Y >(), z = soa.field< Z >(); for ( auto i = 0; i < n; ++i ) res += x[ i ] + y[ i ] + z[ i ]; return res; },
+
+                                            // one SIMD load per field and block (the lanes past n hold 0)
+                                            [ aosoa = AOSOACompactParticle( n ) ]
+                                            {
+                                                auto res = 0;
+                                                for ( std::size_t b = 0; b < aosoa.blockCount(); ++b )
+                                                {
+                                                    const auto& x = aosoa.block< X >( b );
+                                                    const auto& y = aosoa.block< Y >( b );
+                                                    const auto& z = aosoa.block< Z >( b );
+                                                    for ( std::size_t lane = 0; lane < x.size(); ++lane )
+                                                        res += x[ lane ] + y[ lane ] + z[ lane ];
+                                                }
+                                                return res;
+                                            } );
 
         // SOA is faster (diminishingly as n grows)
         if ( byteToAppropriateCacheSize< CompactParticle >( n ) < CacheSize::DRAM )
             BOOST_CHECK( aosT > soaT );
     };
-    run_test< int >( "aos;soa;", test, 4'096, 16'384, 100'000, 1'000'000, 10'000'000, 20'000'000 );
+    run_test< int >( "aos;soa;aosoa;", test, 4'096, 16'384, 100'000, 1'000'000, 10'000'000, 20'000'000 );
 }
 
 BOOST_AUTO_TEST_CASE( CompactRandomAccessAOSvsSOABenchmark )
 {
     auto test = [] ( auto n )
     {
-        double aosT, soaT;
-        std::tie( aosT, soaT ) = benchmark( n,
+        double aosT, soaT, aosoaT;
+        std::tie( aosT, soaT, aosoaT ) = benchmark( n,
                                             [ aos = AOSCompactParticle( n ), n ]
                                             {
                                                 auto res = 0; std::uniform_int_distribution<> rnd( 0, n - 1 ); std::mt19937 gen;
@@ -363,16 +396,29 @@ BOOST_AUTO_TEST_CASE( CompactRandomAccessAOSvsSOABenchmark )
                                                 for ( auto i = 0; i < n; ++i )
                                                 {
                                                     auto idx = rnd( gen );
-                                                    res += soa.x[ idx ] + soa.y[ idx ] + soa.z[ idx ];
+                                                    auto [ x, y, z ] = soa[ idx ];
+                                                    res += x + y + z;
+                                                }
+                                                return res;
+                                            },
+
+                                            // the fields of an element are in the same block (48 bytes with SSE): 1 or 2 cache lines
+                                            [ aosoa = AOSOACompactParticle( n ), n ]
+                                            {
+                                                auto res = 0; std::uniform_int_distribution<> rnd( 0, n - 1 ); std::mt19937 gen;
+                                                for ( auto i = 0; i < n; ++i )
+                                                {
+                                                    auto [ x, y, z ] = aosoa[ rnd( gen ) ];
+                                                    res += x + y + z;
                                                 }
                                                 return res;
                                             } );
 
-        // Similar results, but passed L2 cache, aos is more efficient (less staling due to the 1 prefetch instead of 3)
+        // Similar results, but passed L2 cache, aos is more efficient (less staling due to the 1 prefetch instead of 3), aosoa should be close to aos
         if ( byteToAppropriateCacheSize< CompactParticle >( n ) > CacheSize::L2 )
             BOOST_CHECK( aosT < soaT );
     };
-    run_test< int >( "aos;soa;", test, 512, 4'096, 16'384, 100'000, 1'000'000, 1'200'000, 1'800'000 );
+    run_test< int >( "aos;soa;aosoa;", test, 512, 4'096, 16'384, 100'000, 1'000'000, 1'200'000, 1'800'000 );
 }
 
 namespace
@@ -531,8 +577,11 @@ BOOST_AUTO_TEST_CASE( FalseSharing2Benchmark )
         std::vector< int > matrix( dimension * dimension );
         std::generate( matrix.begin(), matrix.end(), std::rand );
 
-        double notCacheFriendlyT, temporaryT;
-        std::tie( notCacheFriendlyT, temporaryT ) = benchmark( dimension,
+        // each thread counts its own rows
+        const auto rowsPerThread = ( dimension + static_cast< decltype( dimension ) >( MatrixThreadNumber ) - 1 ) / static_cast< decltype( dimension ) >( MatrixThreadNumber );
+
+        double notCacheFriendlyT, temporaryT, combinableT;
+        std::tie( notCacheFriendlyT, temporaryT, combinableT ) = benchmark( dimension,
                                                      [ & ]
                                                      {
                                                          std::vector< std::thread > threads;
@@ -542,8 +591,8 @@ BOOST_AUTO_TEST_CASE( FalseSharing2Benchmark )
                                                          {
                                                              threads.emplace_back( [&]( int threadNumber )
                                                              {
-                                                                 auto startIndex = p * dimension;
-                                                                 auto endIndex = std::min( startIndex + dimension, dimension );
+                                                                 auto startIndex = threadNumber * rowsPerThread;
+                                                                 auto endIndex = std::min( startIndex + rowsPerThread, dimension );
                                                                  for ( auto i = startIndex; i < endIndex; ++i )
                                                                      for ( auto j = 0; j < dimension; ++j )
                                                                          if ( ( matrix[ i * dimension + j ] & 2 ) != 0 )
@@ -565,8 +614,8 @@ BOOST_AUTO_TEST_CASE( FalseSharing2Benchmark )
                                                              threads.emplace_back( [ & ]( int threadNumber )
                                                              {
                                                                  auto result = 0;
-                                                                 auto startIndex = threadNumber * dimension;
-                                                                 auto endIndex = std::min( startIndex + dimension, dimension );
+                                                                 auto startIndex = threadNumber * rowsPerThread;
+                                                                 auto endIndex = std::min( startIndex + rowsPerThread, dimension );
                                                                  for ( auto i = startIndex; i < endIndex; ++i )
                                                                      for ( auto j = 0; j < dimension; ++j )
                                                                          if ( ( matrix[ i * dimension + j ] & 2 ) != 0 )
@@ -579,12 +628,37 @@ BOOST_AUTO_TEST_CASE( FalseSharing2Benchmark )
                                                          for ( auto& thread : threads )
                                                              thread.join();
                                                          return std::accumulate( resultPerThread.begin(), resultPerThread.end(), 0 );
+                                                     },
+                                                     [ & ]
+                                                     {
+                                                         std::vector< std::thread > threads;
+                                                         threads.reserve( MatrixThreadNumber );
+                                                         threading::Combinable< int > resultPerThread; // one padded cache line per thread
+                                                         for ( auto p = 0; p < MatrixThreadNumber; ++p )
+                                                         {
+                                                             threads.emplace_back( [ & ]( int threadNumber )
+                                                             {
+                                                                 auto& result = resultPerThread.local();
+                                                                 auto startIndex = threadNumber * rowsPerThread;
+                                                                 auto endIndex = std::min( startIndex + rowsPerThread, dimension );
+                                                                 for ( auto i = startIndex; i < endIndex; ++i )
+                                                                     for ( auto j = 0; j < dimension; ++j )
+                                                                         if ( ( matrix[ i * dimension + j ] & 2 ) != 0 )
+                                                                             ++result;
+                                                             }, p );
+                                                         }
+
+                                                         for ( auto& thread : threads )
+                                                             thread.join();
+                                                         return resultPerThread.combine( std::plus< int >() );
                                                      } );
 
         BOOST_CHECK( temporaryT < notCacheFriendlyT );
+        if ( std::thread::hardware_concurrency() > 1 ) // on a single core there is no other cache to invalidate the packed counters
+            BOOST_CHECK( combinableT < notCacheFriendlyT );
     };
     // Effect is more apparent with bigger dimension
-    run_test< long long >( "notCacheFriendly;temporary;", test, 1'000, 5'000, 10'000 );
+    run_test< long long >( "notCacheFriendly;temporary;combinable;", test, 1'000, 5'000, 10'000 );
 }
 
 namespace
@@ -656,16 +730,17 @@ namespace
     struct Derived2 : Base { virtual int f() const override final { return 2; } };
     struct Derived3 : Base { virtual int f() const override final { return 3; } };
 
-    template < typename T, typename V, typename C >
-    void    polymorphism_container_add_element( V& v1, V& v2, C& p )
+    template < typename T, typename V, typename C, typename S >
+    void    polymorphism_container_add_element( V& v1, V& v2, C& p, S& s )
     {
         v1.emplace_back( std::make_unique< T >() );
         v2.emplace_back( std::make_unique< T >() );
         p.insert( T() );
+        s.insert( T() );
     }
 
-    template < typename V, typename C >
-    void    init_polymorphic_container( V& v1, V& v2, C& p, size_t n )
+    template < typename V, typename C, typename S >
+    void    init_polymorphic_container( V& v1, V& v2, C& p, S& s, size_t n )
     {
         v1.reserve( n );
         v2.reserve( n );
@@ -676,9 +751,9 @@ namespace
         {
             switch ( rnd( gen ) )
             {
-                case 1: polymorphism_container_add_element< Derived1 >( v1, v2, p ); break;
-                case 2: polymorphism_container_add_element< Derived2 >( v1, v2, p ); break;
-                case 3: default: polymorphism_container_add_element< Derived3 >( v1, v2, p ); break;
+                case 1: polymorphism_container_add_element< Derived1 >( v1, v2, p, s ); break;
+                case 2: polymorphism_container_add_element< Derived2 >( v1, v2, p, s ); break;
+                case 3: default: polymorphism_container_add_element< Derived3 >( v1, v2, p, s ); break;
             }
         }
 
@@ -692,6 +767,8 @@ namespace
 
 // Sorting improve branch prediction even without data locality
 // In this test, it helps greatly the branch prediction as the same virtual table will be used for a long period of time
+// With the derived types known at compile time (staticCollection), f() is not even called through the virtual table anymore
+// The parallel versions split each chunk in cache aligned sub-ranges run on a thread pool, each thread summing in its own Combinable slot
 BOOST_AUTO_TEST_CASE( PolymorphicContainerBenchmark )
 {
     auto f = [] ( auto& v ) { auto res = 0; for ( const auto& e : v ) res += e->f(); return res; };
@@ -699,20 +776,33 @@ BOOST_AUTO_TEST_CASE( PolymorphicContainerBenchmark )
     {
         std::vector< std::unique_ptr< Base > > unsorted, sorted;
         containers::PolymorphicCollection< Base > collection;
+        containers::PolymorphicCollection< Base, Derived1, Derived2, Derived3 > staticCollection;
 
-        init_polymorphic_container( unsorted, sorted, collection, n );
+        init_polymorphic_container( unsorted, sorted, collection, staticCollection, n );
+
+        threading::ThreadPool pool( std::max( 1U, std::thread::hardware_concurrency() ) );
+        auto parallelF = [ &pool ] ( auto& c )
+        {
+            threading::Combinable< int > resultPerThread;
+            c.parallel_for_each( pool, [ &resultPerThread ] ( auto& e ) { resultPerThread.local() += e.f(); } );
+            return resultPerThread.combine( std::plus< int >() );
+        };
 
-        double unsortedT, sortedT, collectionT;
-        std::tie( unsortedT, sortedT, collectionT ) = benchmark( n,
+        double unsortedT, sortedT, collectionT, staticCollectionT, parallelCollectionT, parallelStaticCollectionT;
+        std::tie( unsortedT, sortedT, collectionT, staticCollectionT, parallelCollectionT, parallelStaticCollectionT ) = benchmark( n,
             [ &unsorted, &f ] { return f( unsorted ); },
             [ &sorted, &f ] { return f( sorted ); },
-            [ &collection ] { auto res = 0; collection.for_each( [ &res ] ( auto& e ) { res += e.f(); } ); return res; } );
+            [ &collection ] { auto res = 0; collection.for_each( [ &res ] ( auto& e ) { res += e.f(); } ); return res; },
+            [ &staticCollection ] { auto res = 0; staticCollection.for_each( [ &res ] ( auto& e ) { res += e.f(); } ); return res; },
+            [ &collection, &parallelF ] { return parallelF( collection ); },
+            [ &staticCollection, &parallelF ] { return parallelF( staticCollection ); } );
 
         BOOST_CHECK( unsortedT > sortedT );
         BOOST_CHECK( sortedT > collectionT );
+        BOOST_CHECK( collectionT > staticCollectionT );
     };
 
-    run_test< int >( "unsorted;sorted;collection;", test, 15'000, 100'000, 500'000 );
+    run_test< int >( "unsorted;sorted;collection;staticCollection;parallelCollection;parallelStaticCollection;", test, 15'000, 100'000, 500'000, 4'000'000 );
 }
 
 BOOST_AUTO_TEST_SUITE_END() // ! CacheTestSuite
@@ -0,0 +1,381 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#include <boost/test/unit_test.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/lockfree/stack.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stack>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "containers/BoundedQueueMPMC.h"
+#include "containers/EliminationBackoffStack.h"
+#include "containers/LockBasedQueue.h"
+#include "containers/LockFreeQueueSPSC.h"
+#include "containers/LockFreeStack.h"
+#include "containers/ReclaimingLockFreeStack.h"
+#include "containers/RingBufferSPSC.h"
+#include "tools/CacheMissCounter.h"
+#include "tools/LatencyRecorder.h"
+
+// Sweep of the concurrent queues / stacks over producer and consumer counts, payload sizes and burstiness, against std::mutex + std::queue / std::stack and boost::lockfree
+// One line per scenario: throughput, per-operation latency percentiles (successful try operations, sampled) and hardware cache misses per operation (Linux only, see tools::CacheMissCounter)
+// The harness only needs tryPush( const P& ) / tryPop( P& ), each container is wrapped in an adapter below
+BOOST_AUTO_TEST_SUITE( ConcurrentBenchmarkTestSuite )
+
+namespace
+{
+    // Trivially copyable (boost::lockfree requirement), value is used to check that every element is transferred once
+    template < std::size_t Size >
+    struct Payload
+    {
+        static_assert( Size >= sizeof( long long ) );
+
+        long long   value;
+        char        padding[ Size - sizeof( long long ) ];
+    };
+
+    template < typename P >
+    struct MutexQueue
+    {
+        static constexpr const char* name() { return "std::mutex+std::queue"; }
+
+        bool    tryPush( const P& p ) { std::lock_guard< std::mutex > lock( mutex ); container.push( p ); return true; }
+        bool    tryPop( P& p )
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            if ( container.empty() )
+                return false;
+            p = container.front();
+            container.pop();
+            return true;
+        }
+
+        std::mutex          mutex;
+        std::queue< P >     container;
+    };
+
+    template < typename P >
+    struct MutexStack
+    {
+        static constexpr const char* name() { return "std::mutex+std::stack"; }
+
+        bool    tryPush( const P& p ) { std::lock_guard< std::mutex > lock( mutex ); container.push( p ); return true; }
+        bool    tryPop( P& p )
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            if ( container.empty() )
+                return false;
+            p = container.top();
+            container.pop();
+            return true;
+        }
+
+        std::mutex          mutex;
+        std::stack< P >     container;
+    };
+
+    template < typename P >
+    struct LockBasedQueueAdapter
+    {
+        static constexpr const char* name() { return "LockBasedQueue"; }
+
+        bool    tryPush( const P& p ) { return container.tryPush( p ); }
+        bool    tryPop( P& p ) { return container.tryPop( p ); }
+
+        containers::LockBasedQueue< P >     container;
+    };
+
+    template < typename P >
+    struct LockFreeQueueSPSCAdapter
+    {
+        static constexpr const char* name() { return "LockFreeQueueSPSC"; }
+
+        bool    tryPush( const P& p ) { container.push( p ); return true; }
+        bool    tryPop( P& p )
+        {
+            auto result = container.pop();
+            if ( ! result )
+                return false;
+            p = *result;
+            return true;
+        }
+
+        containers::LockFreeQueueSPSC< P >  container;
+    };
+
+    template < typename P >
+    struct RingBufferSPSCAdapter
+    {
+        static constexpr const char* name() { return "RingBufferSPSC"; }
+
+        bool    tryPush( const P& p ) { return container.try_push( p ); }
+        bool    tryPop( P& p ) { return container.try_pop( p ); }
+
+        containers::RingBufferSPSC< P, 1024 >   container;
+    };
+
+    template < typename P >
+    struct BoundedQueueMPMCAdapter
+    {
+        static constexpr const char* name() { return "BoundedQueueMPMC"; }
+
+        bool    tryPush( const P& p ) { return container.try_push( p ); }
+        bool    tryPop( P& p ) { return container.try_pop( p ); }
+
+        containers::BoundedQueueMPMC< P >   container{ 1024 };
+    };
+
+    template < typename P >
+    struct BoostQueue
+    {
+        static constexpr const char* name() { return "boost::lockfree::queue"; }
+
+        bool    tryPush( const P& p ) { return container.bounded_push( p ); }
+        bool    tryPop( P& p ) { return container.pop( p ); }
+
+        boost::lockfree::queue< P, boost::lockfree::capacity< 1024 > >   container;
+    };
+
+    template < typename P >
+    struct BoostSPSCQueue
+    {
+        static constexpr const char* name() { return "boost::lockfree::spsc_queue"; }
+
+        bool    tryPush( const P& p ) { return container.push( p ); }
+        bool    tryPop( P& p ) { return container.pop( p ); }
+
+        boost::lockfree::spsc_queue< P, boost::lockfree::capacity< 1024 > >  container;
+    };
+
+    template < typename P >
+    struct LockFreeStackAdapter
+    {
+        static constexpr const char* name() { return "LockFreeStack"; }
+
+        bool    tryPush( const P& p ) { container.push( p ); return true; }
+        bool    tryPop( P& p )
+        {
+            auto result = container.pop();
+            if ( ! result )
+                return false;
+            p = *result;
+            return true;
+        }
+
+        containers::LockFreeStack< P >  container;
+    };
+
+    template < typename P >
+    struct ReclaimingLockFreeStackAdapter
+    {
+        static constexpr const char* name() { return "ReclaimingLockFreeStack"; }
+
+        bool    tryPush( const P& p ) { container.push( p ); return true; }
+        bool    tryPop( P& p ) { return container.pop( p ); }
+
+        containers::ReclaimingLockFreeStack< P >    container;
+    };
+
+    template < typename P >
+    struct EliminationBackoffStackAdapter
+    {
+        static constexpr const char* name() { return "EliminationBackoffStack"; }
+
+        bool    tryPush( const P& p ) { container.push( p ); return true; }
+        bool    tryPop( P& p ) { return container.pop( p ); }
+
+        containers::EliminationBackoffStack< P >    container;
+    };
+
+    template < typename P >
+    struct BoostStack
+    {
+        static constexpr const char* name() { return "boost::lockfree::stack"; }
+
+        bool    tryPush( const P& p ) { return container.bounded_push( p ); }
+        bool    tryPop( P& p ) { return container.pop( p ); }
+
+        boost::lockfree::stack< P, boost::lockfree::capacity< 1024 > >   container;
+    };
+
+    struct Scenario
+    {
+        int     producers;
+        int     consumers;
+        bool    isBursty; // producers push Burst elements then stay idle for BurstPause
+    };
+
+    static constexpr const int                          Burst = 256;
+    static constexpr const std::chrono::microseconds    BurstPause( 50 );
+
+    // Transfer n elements (n multiple of the number of producers and consumers) through a new container, print one line if asked and return the sum of the values popped
+    template < template < typename > class Adapter, std::size_t PayloadSize >
+    long long   runScenario( const Scenario& scenario, int n, bool isPrinted )
+    {
+        using P = Payload< PayloadSize >;
+        auto container = std::make_unique< Adapter< P > >(); // boost::lockfree fixed capacity containers are too large for the stack
+
+        tools::CacheMissCounter cacheMisses; // before spawning the threads, inherited by them
+        std::vector< tools::LatencyRecorder > pushLatencies( scenario.producers, tools::LatencyRecorder( n / scenario.producers ) );
+        std::vector< tools::LatencyRecorder > popLatencies( scenario.consumers, tools::LatencyRecorder( n / scenario.consumers ) );
+        std::atomic< long long > sum( 0 );
+        std::atomic< int > readyThreads( 0 );
+        std::atomic< bool > isStarted( false );
+
+        auto waitStart = [ & ] { ++readyThreads; while ( ! isStarted ) std::this_thread::yield(); };
+
+        std::vector< std::thread > threads;
+        for ( auto t = 0; t < scenario.producers; ++t )
+            threads.emplace_back( [ &, t ]
+                {
+                    auto& latencies = pushLatencies[ t ];
+                    const auto count = n / scenario.producers;
+                    P p{};
+                    waitStart();
+                    for ( auto i = 0; i < count; ++i )
+                    {
+                        p.value = static_cast< long long >( t ) * count + i;
+                        while ( ! latencies.record( [ & ] { return container->tryPush( p ); } ) )
+                            std::this_thread::yield();
+
+                        if ( scenario.isBursty && ( i + 1 ) % Burst == 0 )
+                            std::this_thread::sleep_for( BurstPause );
+                    }
+                } );
+
+        for ( auto t = 0; t < scenario.consumers; ++t )
+            threads.emplace_back( [ &, t ]
+                {
+                    auto& latencies = popLatencies[ t ];
+                    long long localSum = 0;
+                    P p;
+                    waitStart();
+                    for ( auto i = n / scenario.consumers; i != 0; --i )
+                    {
+                        while ( ! latencies.record( [ & ] { return container->tryPop( p ); } ) )
+                            std::this_thread::yield();
+                        localSum += p.value;
+                    }
+                    sum += localSum;
+                } );
+
+        while ( readyThreads != scenario.producers + scenario.consumers )
+            std::this_thread::yield();
+
+        cacheMisses.reset();
+        auto startTime = std::chrono::steady_clock::now();
+        isStarted = true;
+        for ( auto& thread : threads )
+            thread.join();
+        auto elapsed = std::chrono::duration< double >( std::chrono::steady_clock::now() - startTime ).count();
+
+        if ( isPrinted )
+        {
+            for ( auto i = 1u; i < pushLatencies.size(); ++i )
+                pushLatencies[ 0 ].merge( pushLatencies[ i ] );
+            for ( auto i = 1u; i < popLatencies.size(); ++i )
+                popLatencies[ 0 ].merge( popLatencies[ i ] );
+
+            std::cout << Adapter< P >::name() << ";" << scenario.producers << ";" << scenario.consumers << ";" << PayloadSize << ";" << ( scenario.isBursty ? "bursty" : "steady" ) << ";"
+                      << n / elapsed / 1E6 << ";"
+                      << pushLatencies[ 0 ].percentile( 50 ) << ";" << pushLatencies[ 0 ].percentile( 99 ) << ";" << pushLatencies[ 0 ].percentile( 99.9 ) << ";"
+                      << popLatencies[ 0 ].percentile( 50 ) << ";" << popLatencies[ 0 ].percentile( 99 ) << ";" << popLatencies[ 0 ].percentile( 99.9 ) << ";";
+            if ( cacheMisses.isAvailable() )
+                std::cout << static_cast< double >( cacheMisses.read() ) / ( 2. * n ) << ";" << std::endl;
+            else
+                std::cout << "n/a;" << std::endl;
+        }
+        return sum;
+    }
+
+    const char* const Header = "container;producers;consumers;payloadBytes;traffic;Melements/s;pushP50ns;pushP99ns;pushP999ns;popP50ns;popP99ns;popP999ns;cacheMisses/op;";
+    const int         ElementNumber = 240'000; // multiple of 1, 2, 3, 4, 6, 8
+
+    template < template < typename > class Adapter, std::size_t PayloadSize >
+    void    sweepThreads( const std::vector< int >& threadCounts )
+    {
+        for ( auto isBursty : { false, true } )
+            for ( auto producers : threadCounts )
+                for ( auto consumers : threadCounts )
+                    runScenario< Adapter, PayloadSize >( Scenario{ producers, consumers, isBursty }, ElementNumber, true );
+    }
+
+    template < template < typename > class Adapter >
+    void    sweep( const std::vector< int >& threadCounts )
+    {
+        sweepThreads< Adapter, 8 >( threadCounts );
+        sweepThreads< Adapter, 64 >( threadCounts );
+        sweepThreads< Adapter, 256 >( threadCounts );
+    }
+
+    template < template < typename > class Adapter >
+    bool    isTransferComplete( const Scenario& scenario )
+    {
+        const auto n = 24'000;
+        return runScenario< Adapter, 64 >( scenario, n, false ) == static_cast< long long >( n ) * ( n - 1 ) / 2;
+    }
+}
+
+// The harness itself: every adapter transfers every element exactly once
+BOOST_AUTO_TEST_CASE( HarnessTest )
+{
+    const Scenario spsc{ 1, 1, false };
+    const Scenario mpmc{ 3, 2, true };
+
+    BOOST_CHECK( isTransferComplete< LockFreeQueueSPSCAdapter >( spsc ) );
+    BOOST_CHECK( isTransferComplete< RingBufferSPSCAdapter >( spsc ) );
+    BOOST_CHECK( isTransferComplete< BoostSPSCQueue >( spsc ) );
+
+    BOOST_CHECK( isTransferComplete< MutexQueue >( mpmc ) );
+    BOOST_CHECK( isTransferComplete< LockBasedQueueAdapter >( mpmc ) );
+    BOOST_CHECK( isTransferComplete< BoundedQueueMPMCAdapter >( mpmc ) );
+    BOOST_CHECK( isTransferComplete< BoostQueue >( mpmc ) );
+
+    BOOST_CHECK( isTransferComplete< MutexStack >( mpmc ) );
+    BOOST_CHECK( isTransferComplete< LockFreeStackAdapter >( mpmc ) );
+    BOOST_CHECK( isTransferComplete< ReclaimingLockFreeStackAdapter >( mpmc ) );
+    BOOST_CHECK( isTransferComplete< EliminationBackoffStackAdapter >( mpmc ) );
+    BOOST_CHECK( isTransferComplete< BoostStack >( mpmc ) );
+}
+
+BOOST_AUTO_TEST_CASE( SPSCQueueSweepBenchmark )
+{
+    std::cout << Header << std::endl;
+    sweep< LockFreeQueueSPSCAdapter >( { 1 } );
+    sweep< RingBufferSPSCAdapter >( { 1 } );
+    sweep< BoostSPSCQueue >( { 1 } );
+    sweep< MutexQueue >( { 1 } );
+}
+
+BOOST_AUTO_TEST_CASE( MPMCQueueSweepBenchmark )
+{
+    std::cout << Header << std::endl;
+    sweep< MutexQueue >( { 1, 2, 4 } );
+    sweep< LockBasedQueueAdapter >( { 1, 2, 4 } );
+    sweep< BoundedQueueMPMCAdapter >( { 1, 2, 4 } );
+    sweep< BoostQueue >( { 1, 2, 4 } );
+}
+
+BOOST_AUTO_TEST_CASE( StackSweepBenchmark )
+{
+    std::cout << Header << std::endl;
+    sweep< MutexStack >( { 1, 2, 4 } );
+    sweep< LockFreeStackAdapter >( { 1, 2, 4 } );
+    sweep< ReclaimingLockFreeStackAdapter >( { 1, 2, 4 } );
+    sweep< EliminationBackoffStackAdapter >( { 1, 2, 4 } );
+    sweep< BoostStack >( { 1, 2, 4 } );
+}
+
+BOOST_AUTO_TEST_SUITE_END() // ConcurrentBenchmarkTestSuite
@@ -3,15 +3,57 @@
 // See https://github.com/Dllieu for updates, documentation, and revision history.
 //--------------------------------------------------------------------------------
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <bitset>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
 #include <thread>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <numeric>
 
 #include "containers/SparseArray.h"
 #include "containers/LockBasedQueue.h"
+#include "containers/AoSoAVector.h"
+#include "containers/BoundedQueueMPMC.h"
+#include "containers/Colony.h"
+#include "containers/ConcurrentHashMap.h"
+#include "containers/EliminationBackoffStack.h"
+#include "containers/FlatHashMap.h"
+#include "containers/HierarchicalBitset.h"
+#include "containers/IntrusiveQueueMPSC.h"
 #include "containers/LockFreeStack.h"
+#include "containers/MulticastRingBuffer.h"
+#include "containers/PerfectHashMap.h"
+#include "containers/PolymorphicCollection.h"
 #include "containers/LockFreeQueueSPSC.h"
+#include "containers/ReclaimingLockFreeStack.h"
+#include "containers/RelocatingVector.h"
+#include "containers/RingBufferSPSC.h"
+#include "containers/SlotMap.h"
+#include "containers/SoAVector.h"
+#include "tools/Benchmark.h"
+#include "threading/Combinable.h"
+#include "threading/EpochReclamation.h"
+#include "threading/EventCount.h"
+#include "threading/HazardPointers.h"
+#include "tools/ThreadAffinity.h"
 
 using namespace containers;
 
+namespace containers
+{
+    // the pointer does not refer to itself: a memcpy to a new address followed by dropping the old bytes is a valid move
+    template < typename T >
+    struct is_trivially_relocatable< std::unique_ptr< T > > : std::true_type
+    {
+        // NOTHING
+    };
+}
+
 BOOST_AUTO_TEST_SUITE( CustomContainerTesSuite )
 
 namespace
@@ -50,7 +92,921 @@ BOOST_AUTO_TEST_CASE( SparseArrayTest )
         else
             BOOST_CHECK_THROW( constBracketOperator( sparseArray, i ), std::out_of_range );
 
-    BOOST_CHECK( sparseArray.size() == 1 );
+    // out of range indexes
+    const auto size = static_cast< std::size_t >( PricingResult::PRICINGRESULT_SIZE );
+    BOOST_CHECK_THROW( sparseArray.isInitialized( size ), std::out_of_range );
+    BOOST_CHECK_THROW( constBracketOperator( sparseArray, size ), std::out_of_range );
+    BOOST_CHECK_THROW( sparseArray[ size ], std::out_of_range );
+    BOOST_CHECK_THROW( sparseArray.reset( size + 64 ), std::out_of_range );
+    BOOST_CHECK_THROW( sparseArray.swap( PricingResult::DELTA, size ), std::out_of_range );
+
+    BOOST_CHECK( sparseArray.size() == 1 && sparseArray[ PricingResult::DELTA ] == 12.0 );
+}
+
+BOOST_AUTO_TEST_CASE( SparseArrayRankTest )
+{
+    // indexes spread over several words and blocks, checked against std::map (ordered as the SparseArray vector)
+    constexpr std::size_t size = 3000;
+    SparseArray< int, size > sparseArray;
+    std::map< std::size_t, int > expected;
+
+    std::mt19937 generator( 42 );
+    std::uniform_int_distribution< std::size_t > indexDistribution( 0, size - 1 );
+    for ( auto i = 0; i < 20'000; ++i )
+    {
+        auto index = indexDistribution( generator );
+        if ( generator() % 3 == 0 )
+        {
+            sparseArray.reset( index );
+            expected.erase( index );
+        }
+        else
+            sparseArray[ index ] = expected[ index ] = i;
+    }
+
+    BOOST_CHECK( sparseArray.size() == expected.size() );
+    for ( std::size_t i = 0; i < size; ++i )
+    {
+        auto it = expected.find( i );
+        BOOST_CHECK( sparseArray.isInitialized( i ) == ( it != expected.end() ) );
+        if ( it != expected.end() )
+            BOOST_CHECK( constBracketOperator( sparseArray, static_cast< int >( i ) ) == it->second );
+    }
+
+    sparseArray.swap( 0, size - 1 );
+    sparseArray.reset();
+    BOOST_CHECK( sparseArray.size() == 0 && ! sparseArray.isInitialized( size - 1 ) );
+
+    // several superblocks of 65536 indexes, the first one full: the counts of the following superblocks are updated / rebuilt
+    constexpr std::size_t largeSize = 200'000;
+    auto large = std::make_unique< SparseArray< int, largeSize > >();
+    for ( std::size_t i = 0; i < 65'536; ++i )
+        ( *large )[ i ] = static_cast< int >( i );
+    for ( std::size_t i = 65'536; i < largeSize; i += 7 )
+        ( *large )[ i ] = static_cast< int >( i );
+
+    // the values are stored in index order, and the lookup of each index (its rank) finds its value
+    auto isConsistent = [ & ]
+    {
+        std::size_t count = 0;
+        auto result = true;
+        large->for_each( [ & ] ( std::size_t index, int value )
+        {
+            result = result && value == static_cast< int >( index ) && constBracketOperator( *large, static_cast< int >( index ) ) == value;
+            ++count;
+        } );
+        return result && count == large->size();
+    };
+    BOOST_CHECK( isConsistent() );
+
+    // rebuilt while the first superblock is full
+    auto indexToReset = std::make_unique< std::bitset< largeSize > >();
+    indexToReset->set( 65'536 );
+    large->resetIndex( *indexToReset );
+    BOOST_CHECK( isConsistent() && ! large->isInitialized( 65'536 ) && constBracketOperator( *large, 199'992 ) == 199'992 );
+
+    large->reset( 100 );
+    ( *large )[ largeSize - 1 ] = static_cast< int >( largeSize - 1 );
+    BOOST_CHECK( isConsistent() && ( *large )[ 150'005 ] == 150'005 );
+
+    indexToReset->reset();
+    for ( std::size_t i = 0; i < largeSize; i += 3 )
+        indexToReset->set( i );
+    large->resetIndex( *indexToReset );
+    BOOST_CHECK( isConsistent() && ! large->isInitialized( 65'550 ) && large->isInitialized( 65'543 ) );
+}
+
+BOOST_AUTO_TEST_CASE( SparseArrayIterationTest )
+{
+    constexpr std::size_t size = 1000;
+    SparseArray< int, size > sparseArray;
+    std::map< std::size_t, int > expected;
+    std::bitset< size > indexToReset;
+
+    std::mt19937 generator( 42 );
+    for ( std::size_t i = 0; i < size; ++i )
+        if ( generator() % 4 == 0 )
+        {
+            sparseArray[ i ] = expected[ i ] = static_cast< int >( i );
+            if ( generator() % 2 == 0 )
+                indexToReset.set( i );
+        }
+    indexToReset.set( 1 ); // not initialized
+
+    auto isExpected = [ & ] ( const auto& array )
+    {
+        std::vector< std::pair< std::size_t, int > > visited;
+        for ( auto element : array )
+            visited.emplace_back( element.first, element.second );
+
+        std::vector< std::pair< std::size_t, int > > forEachVisited;
+        array.for_each( [ & ] ( std::size_t index, const int& value ) { forEachVisited.emplace_back( index, value ); } );
+
+        return visited == std::vector< std::pair< std::size_t, int > >( expected.begin(), expected.end() ) && visited == forEachVisited;
+    };
+    BOOST_CHECK( isExpected( sparseArray ) );
+
+    for ( auto element : sparseArray )
+        element.second *= 2;
+    sparseArray.for_each( [] ( std::size_t, int& value ) { value /= 2; } );
+    BOOST_CHECK( isExpected( sparseArray ) );
+
+    sparseArray.resetIndex( indexToReset );
+    for ( std::size_t i = 0; i < size; ++i )
+        if ( indexToReset.test( i ) )
+            expected.erase( i );
+    BOOST_CHECK( sparseArray.size() == expected.size() );
+    BOOST_CHECK( isExpected( sparseArray ) );
+
+    // the counts are rebuilt: lookups and insertions after a bulk reset
+    sparseArray[ 1 ] = expected[ 1 ] = -1;
+    BOOST_CHECK( isExpected( sparseArray ) );
+    for ( const auto& element : expected )
+        BOOST_CHECK( constBracketOperator( sparseArray, static_cast< int >( element.first ) ) == element.second );
+
+    const SparseArray< int, size > empty;
+    BOOST_CHECK( empty.begin() == empty.end() );
+}
+
+BOOST_AUTO_TEST_CASE( SparseArraySweepBenchmark )
+{
+    // visiting the initialized indexes: probing every index with isInitialized / operator[] vs walking the set bits
+    constexpr std::size_t size = 65'536;
+    auto test = [] ( auto n )
+    {
+        auto sparseArray = std::make_unique< SparseArray< double, size > >();
+        for ( std::size_t i = 0; i < size; i += size / n )
+            ( *sparseArray )[ i ] = static_cast< double >( i );
+        const auto& array = *sparseArray;
+
+        tools::benchmark( n,
+                          [ & ] { auto result = 0.; for ( std::size_t i = 0; i < size; ++i ) if ( array.isInitialized( i ) ) result += array[ i ]; return result; },
+                          [ & ] { auto result = 0.; for ( auto element : array ) result += element.second; return result; },
+                          [ & ] { auto result = 0.; array.for_each( [ & ] ( std::size_t, double value ) { result += value; } ); return result; } );
+    };
+    tools::run_test< double >( "probe;iterator;for_each;", test, 16, 256, 4'096, 65'536 );
+}
+
+namespace
+{
+    // Time per const operator[] on an initialized index, for each fill ratio, against a plain vector indexed directly
+    template < std::size_t N >
+    void    sparseArrayLookup()
+    {
+        tools::display_information< double >( N );
+
+        constexpr std::size_t lookupNumber = 4096;
+        auto makeSparseArray = [] ( double density, std::vector< std::size_t >& lookups )
+        {
+            auto sparseArray = std::make_unique< SparseArray< double, N > >(); // 1M indexes do not fit on the stack
+            std::mt19937 generator( 42 );
+            std::bernoulli_distribution isInitialized( density );
+            for ( std::size_t i = 0; i < N; ++i )
+                if ( isInitialized( generator ) || i == N / 2 )
+                    ( *sparseArray )[ i ] = static_cast< double >( i );
+
+            std::uniform_int_distribution< std::size_t > indexDistribution( 0, N - 1 );
+            while ( lookups.size() < lookupNumber )
+            {
+                auto index = indexDistribution( generator );
+                if ( sparseArray->isInitialized( index ) )
+                    lookups.push_back( index );
+            }
+            return sparseArray;
+        };
+
+        auto lookup = [] ( const auto& container, const std::vector< std::size_t >& lookups )
+        {
+            auto result = 0.;
+            for ( auto index : lookups )
+                result += container[ index ];
+            return result;
+        };
+
+        std::vector< std::size_t > lookups1, lookups10, lookups50, lookups100;
+        auto sparse1 = makeSparseArray( 0.01, lookups1 );
+        auto sparse10 = makeSparseArray( 0.1, lookups10 );
+        auto sparse50 = makeSparseArray( 0.5, lookups50 );
+        auto sparse100 = makeSparseArray( 1., lookups100 );
+        std::vector< double > dense( N );
+
+        tools::benchmark( lookupNumber,
+                          [ & ] { return lookup( static_cast< const SparseArray< double, N >& >( *sparse1 ), lookups1 ); },
+                          [ & ] { return lookup( static_cast< const SparseArray< double, N >& >( *sparse10 ), lookups10 ); },
+                          [ & ] { return lookup( static_cast< const SparseArray< double, N >& >( *sparse50 ), lookups50 ); },
+                          [ & ] { return lookup( static_cast< const SparseArray< double, N >& >( *sparse100 ), lookups100 ); },
+                          [ & ] { return lookup( dense, lookups100 ); } );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( SparseArrayBenchmark )
+{
+    // rank in O(1): the time per lookup should not depend on N (besides the cache level the bits and values fit in) nor on the density
+    std::cout << "infos;n;density1%;density10%;density50%;density100%;vector;" << std::endl;
+    sparseArrayLookup< 64 >();
+    sparseArrayLookup< 1'024 >();
+    sparseArrayLookup< 16'384 >();
+    sparseArrayLookup< 65'536 >();
+    sparseArrayLookup< 1'048'576 >();
+}
+
+BOOST_AUTO_TEST_CASE( HierarchicalBitsetTest )
+{
+    // 300'000 bits: 4 levels of 4688, 74, 2 and 1 words
+    constexpr std::size_t size = 300'000;
+    auto bitset = std::make_unique< HierarchicalBitset< size > >();
+    BOOST_CHECK( bitset->none() && bitset->findFirst() == size );
+
+    std::set< std::size_t > expected;
+    std::mt19937 generator( 42 );
+    std::uniform_int_distribution< std::size_t > indexDistribution( 0, size - 1 );
+    for ( auto i = 0; i < 5'000; ++i )
+    {
+        auto index = indexDistribution( generator );
+        if ( generator() % 4 == 0 )
+            BOOST_CHECK( bitset->reset( index ) == ( expected.erase( index ) == 1 ) );
+        else
+            BOOST_CHECK( bitset->set( index ) == expected.insert( index ).second );
+    }
+    BOOST_CHECK( bitset->set( size - 1 ) == expected.insert( size - 1 ).second );
+
+    BOOST_CHECK( bitset->count() == expected.size() && bitset->any() );
+    BOOST_CHECK( bitset->findFirst() == *expected.begin() );
+    for ( auto index : { std::size_t( 0 ), std::size_t( 63 ), std::size_t( 64 ), std::size_t( 4'095 ), std::size_t( 150'000 ), size - 2 } )
+        BOOST_CHECK( bitset->findFrom( index ) == *expected.lower_bound( index ) );
+    BOOST_CHECK( bitset->findNext( size - 1 ) == size );
+
+    std::vector< std::size_t > visited;
+    bitset->forEach( [ & ] ( std::size_t index ) { visited.push_back( index ); } );
+    BOOST_CHECK( visited == std::vector< std::size_t >( expected.begin(), expected.end() ) );
+
+    visited.clear();
+    for ( auto index = bitset->findFirst(); index != size; index = bitset->findNext( index ) )
+        visited.push_back( index );
+    BOOST_CHECK( visited == std::vector< std::size_t >( expected.begin(), expected.end() ) );
+
+    bitset->reset( 1'000, 200'000 );
+    expected.erase( expected.lower_bound( 1'000 ), expected.lower_bound( 200'000 ) );
+    BOOST_CHECK( bitset->count() == expected.size() && bitset->findFrom( 1'000 ) == *expected.lower_bound( 1'000 ) );
+
+    bitset->reset();
+    BOOST_CHECK( bitset->none() && bitset->count() == 0 && bitset->findFirst() == size );
+    for ( auto index : expected )
+        BOOST_CHECK( ! bitset->test( index ) );
+
+    // a sparse array over a large universe, few indexes initialized
+    auto sparseArray = std::make_unique< SparseArray< int, 10'000'000 > >();
+    BOOST_CHECK( sparseArray->empty() );
+    ( *sparseArray )[ 9'999'999 ] = 2;
+    ( *sparseArray )[ 12 ] = 1;
+    std::vector< std::pair< std::size_t, int > > elements;
+    for ( auto element : *sparseArray )
+        elements.emplace_back( element.first, element.second );
+    BOOST_CHECK( ( elements == std::vector< std::pair< std::size_t, int > >{ { 12, 1 }, { 9'999'999, 2 } } ) );
+}
+
+BOOST_AUTO_TEST_CASE( HierarchicalBitsetBenchmark )
+{
+    // walking the bits set of 16M bits: through the summary levels vs scanning every word
+    constexpr std::size_t size = 1 << 24;
+    auto test = [] ( auto n )
+    {
+        auto bitset = std::make_unique< HierarchicalBitset< size > >();
+        std::vector< std::uint64_t > flat( size / 64 );
+        std::mt19937 generator( 42 );
+        while ( bitset->count() < static_cast< std::size_t >( n ) )
+        {
+            auto index = generator() % size;
+            bitset->set( index );
+            flat[ index / 64 ] |= std::uint64_t( 1 ) << ( index % 64 );
+        }
+
+        tools::benchmark( n,
+                          [ & ] { std::size_t result = 0; for ( auto i = bitset->findFirst(); i != size; i = bitset->findNext( i ) ) result += i; return result; },
+                          [ & ] { std::size_t result = 0; bitset->forEach( [ & ] ( std::size_t i ) { result += i; } ); return result; },
+                          [ & ]
+                          {
+                              std::size_t result = 0;
+                              for ( std::size_t word = 0; word < flat.size(); ++word )
+                                  for ( auto bits = flat[ word ]; bits != 0; bits &= bits - 1 )
+                                      result += word * 64 + generics::countTrailingZeros( bits );
+                              return result;
+                          } );
+    };
+    tools::run_test< std::uint64_t >( "findNext;forEach;flatScan;", test, 16, 4'096, 262'144 );
+}
+
+BOOST_AUTO_TEST_CASE( RelocatingVectorTest )
+{
+    // malloc / realloc, then mremap once the buffer is past the threshold (1M ints: 4MB), then back to the heap
+    RelocatingVector< int > ints;
+    for ( auto i = 0; i < 1'000'000; ++i )
+        ints.push_back( i );
+    BOOST_CHECK( ints.size() == 1'000'000 && ints.capacity() >= ints.size() );
+    BOOST_CHECK( std::accumulate( ints.begin(), ints.end(), 0LL ) == 999'999LL * 1'000'000 / 2 );
+
+    ints.resize( 100 );
+    ints.shrink_to_fit();
+    BOOST_CHECK( ints.capacity() == 100 && ints.back() == 99 );
+
+    auto copy = ints;
+    ints.clear();
+    BOOST_CHECK( ints.empty() && copy.size() == 100 && copy[ 42 ] == 42 );
+    BOOST_CHECK_THROW( copy.at( 100 ), std::out_of_range );
+
+    // moved element by element
+    RelocatingVector< std::string > strings;
+    for ( auto i = 0; i < 1'000; ++i )
+        strings.emplace_back( std::to_string( i ) + " is not a small string" );
+    BOOST_CHECK( ! RelocatingVector< std::string >::IsRelocatedByMemcpy && strings[ 999 ] == "999 is not a small string" );
+
+    // an element inserted in its own full vector is read before the growth releases it
+    while ( strings.size() != strings.capacity() )
+        strings.emplace_back( strings.back() );
+    strings.push_back( strings[ 0 ] );
+    BOOST_CHECK( strings.back() == "0 is not a small string" );
+    strings.resize( strings.capacity() + 1, strings[ 1 ] );
+    BOOST_CHECK( strings.back() == "1 is not a small string" );
+
+    RelocatingVector< int > aliased( 3, 7 );
+    while ( aliased.size() != aliased.capacity() )
+        aliased.push_back( 7 );
+    aliased.push_back( aliased.front() );
+    aliased.resize( aliased.capacity() + 1, aliased.back() );
+    BOOST_CHECK( std::all_of( aliased.begin(), aliased.end(), [] ( int v ) { return v == 7; } ) );
+
+    // relocated by memcpy (specialization above), each pointer is deleted once by the destructor
+    static_assert( RelocatingVector< std::unique_ptr< int > >::IsRelocatedByMemcpy, "unique_ptr is trivially relocatable" );
+    {
+        RelocatingVector< std::unique_ptr< int > > pointers;
+        for ( auto i = 0; i < 100'000; ++i )
+            pointers.push_back( std::make_unique< int >( i ) );
+        BOOST_CHECK( *pointers[ 0 ] == 0 && *pointers.back() == 99'999 );
+    }
+
+    // growth policies
+    RelocatingVector< int, VectorGrowthPolicyIncremental< 100, 1000 > > incremental;
+    incremental.push_back( 0 );
+    BOOST_CHECK( incremental.capacity() == 100 );
+    for ( auto i = 1; i < 1'001; ++i )
+        incremental.push_back( i );
+    BOOST_CHECK( incremental.capacity() == 2'000 ); // capped at 1000 by the policy, then doubled
+    for ( auto i = 0; i < 101; ++i )
+        incremental.pop_back();
+    BOOST_CHECK( incremental.capacity() == 900 && incremental.back() == 899 );
+
+    SparseArray< RelocatingVector< int >, 16, VectorGrowthPolicyIncrementalByOne > sparseArray;
+    sparseArray[ 3 ].push_back( 3 );
+    BOOST_CHECK( sparseArray[ 3 ].front() == 3 );
+}
+
+BOOST_AUTO_TEST_CASE( RelocatingVectorBenchmark )
+{
+    // push_back of n ticks from empty: std::vector move constructs every element into a new buffer at each growth
+    struct Tick
+    {
+        std::int64_t    timestamp;
+        double          price;
+        double          quantity;
+    };
+
+    auto test = [] ( auto n )
+    {
+        tools::benchmark( n,
+                          [ n ] { RelocatingVector< Tick > ticks; for ( auto i = 0; i < n; ++i ) ticks.push_back( Tick{ i, 1., 1. } ); return ticks.size(); },
+                          [ n ] { std::vector< Tick > ticks; for ( auto i = 0; i < n; ++i ) ticks.push_back( Tick{ i, 1., 1. } ); return ticks.size(); } );
+    };
+    tools::run_test< Tick >( "relocatingVector;stdVector;", test, 10'000, 1'000'000, 10'000'000, 50'000'000 );
+}
+
+BOOST_AUTO_TEST_CASE( SlotMapTest )
+{
+    SlotMap< std::string > slotMap;
+
+    auto a = slotMap.insert( "a" );
+    auto b = slotMap.insert( "b" );
+    auto c = slotMap.emplace( 1, 'c' );
+    BOOST_CHECK( slotMap.size() == 3 && slotMap[ a ] == "a" && slotMap[ b ] == "b" && slotMap[ c ] == "c" );
+
+    // the last value fills the hole, the handles still resolve
+    BOOST_CHECK( slotMap.erase( a ) );
+    BOOST_CHECK( slotMap.size() == 2 && slotMap[ b ] == "b" && slotMap[ c ] == "c" );
+    BOOST_CHECK( *slotMap.begin() == "c" && slotMap.handleAt( 0 ) == c );
+
+    // stale handle, even once its slot is reused
+    auto d = slotMap.insert( "d" );
+    BOOST_CHECK( d.index == a.index && d != a );
+    BOOST_CHECK( ! slotMap.contains( a ) && slotMap.find( a ) == nullptr && ! slotMap.erase( a ) );
+    BOOST_CHECK_THROW( slotMap[ a ], std::out_of_range );
+    BOOST_CHECK( slotMap[ d ] == "d" );
+
+    slotMap.clear();
+    BOOST_CHECK( slotMap.empty() && ! slotMap.contains( b ) && ! slotMap.contains( d ) );
+
+    // churn checked against std::map
+    SlotMap< int > values;
+    std::map< int, SlotMapHandle > expected;
+    std::mt19937 generator( 42 );
+    for ( auto i = 0; i < 10'000; ++i )
+        if ( ! expected.empty() && generator() % 2 == 0 )
+        {
+            auto it = std::next( expected.begin(), generator() % expected.size() );
+            BOOST_CHECK( values.erase( it->second ) );
+            expected.erase( it );
+        }
+        else
+            expected.emplace( i, values.insert( i ) );
+
+    BOOST_CHECK( values.size() == expected.size() );
+    for ( const auto& element : expected )
+        BOOST_CHECK( values[ element.second ] == element.first );
+    BOOST_CHECK( std::accumulate( values.begin(), values.end(), 0LL ) == std::accumulate( expected.begin(), expected.end(), 0LL, [] ( auto sum, const auto& element ) { return sum + element.first; } ) );
+}
+
+BOOST_AUTO_TEST_CASE( SlotMapBenchmark )
+{
+    // objects created / destroyed at high rate: n inserts, n / 2 random erases by handle (id), lookups then a sweep of the live ones
+    struct Order
+    {
+        std::int64_t    id;
+        double          price;
+        double          quantity;
+    };
+
+    auto test = [] ( auto n )
+    {
+        std::vector< std::size_t > eraseOrder( n );
+        std::iota( eraseOrder.begin(), eraseOrder.end(), 0 );
+        std::shuffle( eraseOrder.begin(), eraseOrder.end(), std::mt19937( 42 ) );
+        eraseOrder.resize( n / 2 );
+
+        tools::benchmark( n,
+            [ & ]
+            {
+                SlotMap< Order > orders;
+                std::vector< SlotMapHandle > handles;
+                for ( auto i = 0; i < n; ++i )
+                    handles.push_back( orders.insert( Order{ i, 1., 1. } ) );
+                for ( auto i : eraseOrder )
+                    orders.erase( handles[ i ] );
+
+                auto result = 0.;
+                for ( auto handle : handles )
+                    if ( auto order = orders.find( handle ) )
+                        result += order->price;
+                for ( const auto& order : orders )
+                    result += order.quantity;
+                return result;
+            },
+            [ & ]
+            {
+                std::unordered_map< std::int64_t, Order > orders;
+                for ( auto i = 0; i < n; ++i )
+                    orders.emplace( i, Order{ i, 1., 1. } );
+                for ( auto i : eraseOrder )
+                    orders.erase( static_cast< std::int64_t >( i ) );
+
+                auto result = 0.;
+                for ( auto i = 0; i < n; ++i )
+                {
+                    auto it = orders.find( i );
+                    if ( it != orders.end() )
+                        result += it->second.price;
+                }
+                for ( const auto& order : orders )
+                    result += order.second.quantity;
+                return result;
+            } );
+    };
+    tools::run_test< Order >( "slotMap;unordered_map;", test, 1'000, 100'000, 1'000'000 );
+}
+
+namespace
+{
+    struct Shape { virtual ~Shape() = default; virtual double area() const = 0; int visits = 0; };
+    struct Square : Shape { explicit Square( double side ) : side( side ) {} double area() const override final { return side * side; } double side; };
+    struct Circle : Shape { explicit Circle( double radius ) : radius( radius ) {} double area() const override final { return 3 * radius * radius; } double radius; };
+}
+
+BOOST_AUTO_TEST_CASE( PolymorphicCollectionTest )
+{
+    PolymorphicCollection< Shape > dynamicCollection;
+    PolymorphicCollection< Shape, Square, Circle > staticCollection;
+    for ( auto i = 1; i <= 10; ++i )
+    {
+        dynamicCollection.insert( Square( i ) );
+        dynamicCollection.insert( Circle( i ) );
+        staticCollection.insert( Square( i ) );
+        const Circle circle( i );
+        staticCollection.insert( circle );
+    }
+
+    auto dynamicArea = 0.;
+    dynamicCollection.for_each( [ & ] ( const Shape& shape ) { dynamicArea += shape.area(); } );
+
+    // f receives the derived type
+    auto staticArea = 0.;
+    auto circleCount = 0;
+    const auto& constStaticCollection = staticCollection;
+    constStaticCollection.for_each( [ & ] ( const auto& shape )
+    {
+        staticArea += shape.area();
+        circleCount += std::is_same< std::decay_t< decltype( shape ) >, Circle >::value;
+    } );
+
+    BOOST_CHECK( dynamicArea == 4 * 385 && staticArea == dynamicArea );
+    BOOST_CHECK( circleCount == 10 && staticCollection.size() == 20 && staticCollection.chunk< Square >().size() == 10 );
+
+    // erase through the handles, the other elements do not move
+    auto square = staticCollection.insert( Square( 11 ) );
+    auto circle = dynamicCollection.insert( Circle( 11 ) );
+    auto squareAddress = staticCollection.get( square );
+    auto circleAddress = dynamicCollection.get( circle );
+    BOOST_CHECK( squareAddress->area() == 121 && circleAddress->area() == 363 );
+
+    std::vector< PolymorphicCollection< Shape, Square, Circle >::Handle > staticHandles;
+    std::vector< PolymorphicCollection< Shape >::Handle > dynamicHandles;
+    for ( auto i = 0; i < 200; ++i )
+    {
+        staticHandles.push_back( staticCollection.insert( Circle( 0 ) ) );
+        dynamicHandles.push_back( dynamicCollection.insert( Square( 0 ) ) );
+    }
+    for ( auto i = 0; i < 200; ++i )
+    {
+        BOOST_CHECK( staticCollection.erase( staticHandles[ i ] ) && ! staticCollection.erase( staticHandles[ i ] ) );
+        BOOST_CHECK( dynamicCollection.erase( dynamicHandles[ i ] ) && dynamicCollection.get( dynamicHandles[ i ] ) == nullptr );
+    }
+    BOOST_CHECK( staticCollection.erase( square ) && staticCollection.get( square ) == nullptr );
+
+    // the slots of the stale handles are reused by the next insertions, the stale handles stay rejected
+    auto squareReusingSlot = staticCollection.insert( Square( 12 ) );
+    auto squareInDynamic = dynamicCollection.insert( Square( 12 ) );
+    BOOST_CHECK( squareReusingSlot.position.block == square.position.block && squareReusingSlot.position.slot == square.position.slot );
+    BOOST_CHECK( staticCollection.get( square ) == nullptr && ! staticCollection.erase( square ) );
+    BOOST_CHECK( dynamicCollection.get( dynamicHandles[ 0 ] ) == nullptr && ! dynamicCollection.erase( dynamicHandles[ 0 ] ) );
+    BOOST_CHECK( staticCollection.erase( squareReusingSlot ) && dynamicCollection.erase( squareInDynamic ) );
+    BOOST_CHECK( staticCollection.size() == 20 && dynamicCollection.size() == 21 && dynamicCollection.get( circle ) == circleAddress );
+
+    dynamicArea = 0.;
+    dynamicCollection.for_each( [ & ] ( const Shape& shape ) { dynamicArea += shape.area(); } );
+    BOOST_CHECK( dynamicArea == 4 * 385 + 363 );
+}
+
+BOOST_AUTO_TEST_CASE( ColonyTest )
+{
+    Colony< std::string > colony;
+    std::map< std::string, ColonyHandle > expected;
+    std::map< std::string, const std::string* > addresses;
+
+    std::mt19937 generator( 42 );
+    for ( auto i = 0; i < 10'000; ++i )
+        if ( ! expected.empty() && generator() % 3 == 0 )
+        {
+            auto it = std::next( expected.begin(), generator() % expected.size() );
+            BOOST_CHECK( colony.erase( it->second ) && colony.get( it->second ) == nullptr );
+            addresses.erase( it->first );
+            expected.erase( it );
+        }
+        else
+        {
+            auto value = std::to_string( i ) + " is not a small string";
+            auto handle = colony.insert( value );
+            expected.emplace( value, handle );
+            addresses.emplace( value, colony.get( handle ) );
+        }
+
+    // the elements never moved, the erased slots were reused (at most one block more than needed)
+    BOOST_CHECK( colony.size() == expected.size() );
+    BOOST_CHECK( colony.blockCount() * Colony< std::string >::BlockSize < ( 10'000 * 2 / 3 ) + Colony< std::string >::BlockSize );
+    for ( const auto& element : expected )
+        BOOST_CHECK( colony[ element.second ] == element.first && colony.get( element.second ) == addresses[ element.first ] );
+
+    std::set< std::string > visited;
+    colony.for_each( [ & ] ( const std::string& value ) { visited.insert( value ); } );
+    BOOST_CHECK( visited.size() == expected.size() && std::equal( visited.begin(), visited.end(), expected.begin(), [] ( const auto& v, const auto& e ) { return v == e.first; } ) );
+
+    BOOST_CHECK( reinterpret_cast< std::uintptr_t >( colony.element( 0, 0 ) ) % tools::CacheLineSize == 0 );
+
+    colony.clear();
+    BOOST_CHECK( colony.empty() && colony.get( expected.begin()->second ) == nullptr );
+    auto handle = colony.insert( "reused" );
+    BOOST_CHECK( handle.block == 0 && handle.slot == 0 && colony.blockCount() > 0 );
+
+    // a stale handle is rejected, even though its slot holds another element
+    BOOST_CHECK( colony.erase( handle ) );
+    const auto reinserted = colony.insert( "reinserted" );
+    BOOST_CHECK( reinserted.block == handle.block && reinserted.slot == handle.slot && reinserted != handle );
+    BOOST_CHECK( colony.get( handle ) == nullptr && ! colony.erase( handle ) && *colony.get( reinserted ) == "reinserted" && colony.size() == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( PolymorphicCollectionParallelTest )
+{
+    PolymorphicCollection< Shape > dynamicCollection;
+    PolymorphicCollection< Shape, Square, Circle > staticCollection;
+    for ( auto i = 0; i < 10'000; ++i )
+    {
+        dynamicCollection.insert( Square( i % 7 ) );
+        dynamicCollection.insert( Circle( i % 5 ) );
+        staticCollection.insert( Square( i % 7 ) );
+        staticCollection.insert( Circle( i % 5 ) );
+    }
+
+    threading::ThreadPool pool( 4 );
+    auto check = [ &pool ] ( auto& collection, std::size_t grainSize )
+    {
+        threading::Combinable< double > area;
+        collection.parallel_for_each( pool, [ &area ] ( auto& shape ) { ++shape.visits; area.local() += shape.area(); }, grainSize );
+
+        auto expectedArea = 0.;
+        auto isVisitedOnce = true;
+        collection.for_each( [ & ] ( auto& shape ) { expectedArea += shape.area(); isVisitedOnce &= shape.visits == 1; shape.visits = 0; } );
+        return isVisitedOnce && area.combine( std::plus< double >() ) == expectedArea;
+    };
+
+    BOOST_CHECK( check( dynamicCollection, 0 ) );
+    BOOST_CHECK( check( dynamicCollection, 100 ) );
+    BOOST_CHECK( check( staticCollection, 0 ) );
+    BOOST_CHECK( check( staticCollection, 1 ) );
+
+    BOOST_CHECK_THROW( staticCollection.parallel_for_each( pool, [] ( auto& ) { throw std::runtime_error( "f" ); } ), std::runtime_error );
+
+    // tasks of whole blocks: 10 blocks in tasks of about 200 elements (4 blocks)
+    std::vector< std::pair< std::size_t, std::size_t > > ranges;
+    details::splitBlocks( 10, 200, [ &ranges ] ( std::size_t first, std::size_t last ) { ranges.emplace_back( first, last ); } );
+    BOOST_CHECK( ( ranges == std::vector< std::pair< std::size_t, std::size_t > >{ { 0, 4 }, { 4, 8 }, { 8, 10 } } ) );
+}
+
+BOOST_AUTO_TEST_CASE( SoAVectorTest )
+{
+    SoAVector< int, double, std::string > soa;
+    for ( auto i = 0; i < 100; ++i )
+        soa.emplace_back( i, i / 2., std::to_string( i ) );
+    soa.push_back( std::make_tuple( 100, 50., std::string( "100" ) ) );
+    BOOST_CHECK( soa.size() == 101 && soa.capacity() >= 101 );
+
+    // the proxy reads and writes the fields in place
+    auto [ i, d, s ] = soa[ 10 ];
+    BOOST_CHECK( i == 10 && d == 5. && s == "10" );
+    i = -10;
+    s += "!";
+    BOOST_CHECK( soa.field< 0 >()[ 10 ] == -10 && soa.field< 2 >()[ 10 ] == "10!" );
+    soa[ 11 ] = soa[ 12 ];
+    BOOST_CHECK( soa[ 11 ] == std::make_tuple( 12, 6., std::string( "12" ) ) );
+    std::tuple< int, double, std::string > value = soa.back();
+    BOOST_CHECK( std::get< 0 >( value ) == 100 && std::get< 2 >( value ) == "100" );
+
+    // the fields are contiguous arrays, starting on a cache line
+    auto ints = soa.field< 0 >();
+    auto doubles = soa.field< 1 >();
+    BOOST_CHECK( ints.size() == soa.size() && reinterpret_cast< std::uintptr_t >( ints.data() ) % tools::CacheLineSize == 0 );
+    BOOST_CHECK( reinterpret_cast< std::uintptr_t >( doubles.data() ) % tools::CacheLineSize == 0 );
+    BOOST_CHECK( std::accumulate( doubles.begin(), doubles.end(), 0. ) == 5'050. / 2 + .5 ); // soa[ 11 ] holds 6 instead of 5.5
+
+    // erase shifts every field
+    soa.erase( soa.begin() + 11 );
+    soa.erase( soa.begin(), soa.begin() + 10 );
+    BOOST_CHECK( soa.size() == 90 && soa.front().get< 2 >() == "10!" && soa[ 1 ] == std::make_tuple( 12, 6., std::string( "12" ) ) );
+    BOOST_CHECK( soa.field< 0 >().size() == 90 && soa.field< 2 >().size() == 90 );
+
+    auto expected = 10;
+    for ( auto element : soa )
+    {
+        BOOST_CHECK( element.get< 2 >() == std::to_string( expected ) + ( expected == 10 ? "!" : "" ) );
+        expected += expected == 10 ? 2 : 1;
+    }
+
+    BOOST_CHECK_THROW( soa.at( 90 ), std::out_of_range );
+    soa.resize( 3 );
+    soa.pop_back();
+    BOOST_CHECK( soa.size() == 2 && soa.field< 1 >().size() == 2 );
+    soa.clear();
+    BOOST_CHECK( soa.empty() && soa.begin() == soa.end() );
+
+    // the fields of an element inserted in its own full vector are read before the reallocation
+    soa.emplace_back( 1, 1., "not a small string, allocated" );
+    while ( soa.size() != soa.capacity() )
+        soa.push_back( soa.back() );
+    soa.emplace_back( soa.front().get< 0 >(), soa.front().get< 1 >(), soa.front().get< 2 >() );
+    BOOST_CHECK( soa.back() == std::make_tuple( 1, 1., std::string( "not a small string, allocated" ) ) );
+
+    const auto first = soa.cbegin();
+    const auto last = soa.cend();
+    BOOST_CHECK( last > first && first <= first && last >= first && ! ( first > last ) && 2 + first == first + 2 );
+    BOOST_CHECK( static_cast< std::size_t >( std::distance( first, last ) ) == soa.size() );
+}
+
+BOOST_AUTO_TEST_CASE( AoSoAVectorTest )
+{
+    using Element = std::tuple< int, double, std::string >;
+    AoSoAVector< 4, int, double, std::string > aosoa;
+    std::vector< Element > expected;
+    for ( auto i = 0; i < 10; ++i )
+    {
+        aosoa.emplace_back( i, i / 2., std::to_string( i ) );
+        expected.emplace_back( i, i / 2., std::to_string( i ) );
+    }
+
+    // blocks of 4 elements, each field contiguous in its block, the lanes past the size are value initialized
+    BOOST_CHECK( aosoa.size() == 10 && aosoa.blockCount() == 3 && aosoa.blockSize( 0 ) == 4 && aosoa.blockSize( 2 ) == 2 );
+    const auto& ints = aosoa.block< 0 >( 1 );
+    BOOST_CHECK( ints[ 0 ] == 4 && ints[ 3 ] == 7 && &ints[ 0 ] + 3 == &aosoa.block< 0 >( 1 )[ 3 ] );
+    BOOST_CHECK( aosoa.block< 1 >( 2 )[ 1 ] == 4.5 && aosoa.block< 1 >( 2 )[ 2 ] == 0. && aosoa.block< 2 >( 2 )[ 3 ].empty() );
+
+    // fields of the same size: every field block is aligned for the SIMD loads
+    AoSoAVector< 4, int, int, int > aligned( 9 );
+    for ( std::size_t b = 0; b < aligned.blockCount(); ++b )
+        BOOST_CHECK( reinterpret_cast< std::uintptr_t >( aligned.block< 0 >( b ).data() ) % ( 4 * sizeof( int ) ) == 0
+                  && reinterpret_cast< std::uintptr_t >( aligned.block< 2 >( b ).data() ) % ( 4 * sizeof( int ) ) == 0 );
+
+    auto [ i, d, s ] = aosoa[ 5 ];
+    BOOST_CHECK( i == 5 && d == 2.5 && s == "5" );
+    s = "five";
+    std::get< 2 >( expected[ 5 ] ) = "five";
+
+    std::mt19937 generator( 42 );
+    for ( auto n = 0; n < 200; ++n )
+        if ( ! expected.empty() && generator() % 2 == 0 )
+        {
+            auto position = generator() % expected.size();
+            aosoa.erase( aosoa.begin() + position );
+            expected.erase( expected.begin() + position );
+        }
+        else
+        {
+            aosoa.push_back( Element( n, n * 2., std::to_string( n * 3 ) ) );
+            expected.emplace_back( n, n * 2., std::to_string( n * 3 ) );
+        }
+
+    BOOST_CHECK( aosoa.size() == expected.size() && aosoa.blockCount() == ( expected.size() + 3 ) / 4 );
+    BOOST_CHECK( std::equal( aosoa.begin(), aosoa.end(), expected.begin(), [] ( const auto& a, const auto& e ) { return a == e; } ) );
+    for ( auto lane = aosoa.blockSize( aosoa.blockCount() - 1 ); lane < 4; ++lane )
+        BOOST_CHECK( aosoa.block< 0 >( aosoa.blockCount() - 1 )[ lane ] == 0 && aosoa.block< 2 >( aosoa.blockCount() - 1 )[ lane ].empty() );
+
+    BOOST_CHECK_THROW( aosoa.at( aosoa.size() ), std::out_of_range );
+    aosoa.resize( 5 );
+    aosoa.pop_back();
+    BOOST_CHECK( aosoa.size() == 4 && aosoa.blockCount() == 1 && aosoa.back() == expected[ 3 ] );
+    aosoa.clear();
+    BOOST_CHECK( aosoa.empty() && aosoa.blockCount() == 0 );
+
+    // the fields of an element inserted in a new block are read before the blocks are reallocated
+    AoSoAVector< 4, int, double, std::string > aliased;
+    aliased.emplace_back( 1, 1., "not a small string, allocated" );
+    for ( auto n = 0; n < 100; ++n )
+        aliased.emplace_back( aliased.front().get< 0 >(), aliased.front().get< 1 >(), aliased.front().get< 2 >() );
+    BOOST_CHECK( std::all_of( aliased.begin(), aliased.end(), [] ( const auto& e ) { return e == Element( 1, 1., "not a small string, allocated" ); } ) );
+}
+
+namespace
+{
+    struct StringHash
+    {
+        using is_transparent = void;
+        std::size_t     operator()( std::string_view s ) const { return std::hash< std::string_view >()( s ); }
+    };
+}
+
+BOOST_AUTO_TEST_CASE( FlatHashMapTest )
+{
+    FlatHashMap< std::uint64_t, int > map;
+    std::unordered_map< std::uint64_t, int > expected;
+
+    std::mt19937 generator( 42 );
+    for ( auto i = 0; i < 200'000; ++i )
+    {
+        const std::uint64_t key = generator() % 20'000;
+        switch ( generator() % 3 )
+        {
+            case 0: BOOST_CHECK( map.erase( key ) == expected.erase( key ) ); break;
+            case 1: BOOST_CHECK( map.emplace( key, i ).second == expected.emplace( key, i ).second ); break;
+            default:
+            {
+                auto it = map.find( key );
+                auto expectedIt = expected.find( key );
+                BOOST_CHECK( ( it == map.end() ) == ( expectedIt == expected.end() ) && ( it == map.end() || it->second == expectedIt->second ) );
+            }
+        }
+    }
+    BOOST_CHECK( map.size() == expected.size() && ( map.capacity() & ( map.capacity() - 1 ) ) == 0 );
+    BOOST_CHECK( static_cast< std::size_t >( std::distance( map.begin(), map.end() ) ) == expected.size() );
+    for ( const auto& value : map )
+        BOOST_CHECK( expected.at( value.first ) == value.second );
+
+    // order book: the live orders are a sliding window of ids, the erased slots are reused without growing
+    FlatHashMap< std::uint64_t, double > orders;
+    orders.reserve( 1'000 );
+    const auto capacity = orders.capacity();
+    for ( std::uint64_t id = 0; id < 1'000; ++id )
+        orders[ id ] = static_cast< double >( id );
+    for ( std::uint64_t id = 1'000; id < 200'000; ++id )
+    {
+        BOOST_CHECK( orders.erase( id - 1'000 ) == 1 );
+        orders.emplace( id, static_cast< double >( id ) );
+    }
+    BOOST_CHECK( orders.capacity() == capacity && orders.size() == 1'000 && orders.at( 199'999 ) == 199'999. && ! orders.contains( 198'999 ) );
+    BOOST_CHECK_THROW( orders.at( 0 ), std::out_of_range );
+
+    for ( auto it = orders.begin(); it != orders.end(); )
+        it = it->first % 2 == 0 ? orders.erase( it ) : std::next( it );
+    BOOST_CHECK( orders.size() == 500 && orders.count( 199'999 ) == 1 && orders.count( 199'998 ) == 0 );
+
+    // heterogeneous lookup: no std::string built for the lookups
+    FlatHashMap< std::string, int, StringHash, std::equal_to<> > names { { "bid", 1 }, { "ask", 2 } };
+    BOOST_CHECK( names.find( std::string_view( "ask" ) )->second == 2 && names.contains( "bid" ) && ! names.contains( std::string_view( "mid" ) ) );
+    BOOST_CHECK( names.erase( std::string_view( "bid" ) ) == 1 && names.size() == 1 );
+
+    auto copy = names;
+    names.clear();
+    BOOST_CHECK( names.empty() && names.begin() == names.end() && copy.at( "ask" ) == 2 );
+
+    // the key is converted to Key before being hashed (std::equal_to< Key > is not transparent)
+    FlatHashMap< double, int > prices;
+    prices.emplace( 1, 10 );
+    BOOST_CHECK( prices.count( 1.0 ) == 1 );
+    prices[ 1.0 ] = 20;
+    BOOST_CHECK( prices.size() == 1 && prices.at( 1.0 ) == 20 );
+    BOOST_CHECK( ! prices.insert_or_assign( 1, 30 ).second && prices.at( 1.0 ) == 30 && ! prices.try_emplace( 1.f, 40 ).second );
+
+    FlatHashMap< std::uint32_t, int > ids;
+    ids.emplace( -1, 1 );
+    BOOST_CHECK( ids.count( 0xFFFFFFFFu ) == 1 && ! ids.emplace( 0xFFFFFFFFu, 2 ).second && ids.size() == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( FlatHashMapBenchmark )
+{
+    // order id -> order, ids increasing with gaps (several feeds / venues), time per operation
+    struct Order
+    {
+        double  price;
+        double  quantity;
+    };
+
+    auto test = [] ( auto n )
+    {
+        std::vector< std::uint64_t > ids( n );
+        std::mt19937_64 generator( 42 );
+        std::uint64_t id = 1'000'000;
+        for ( auto& i : ids )
+            i = id += 1 + generator() % 8;
+        auto lookups = ids;
+        std::shuffle( lookups.begin(), lookups.end(), generator );
+        std::vector< std::uint64_t > misses( n );
+        std::transform( lookups.begin(), lookups.end(), misses.begin(), [] ( auto i ) { return i + ( std::uint64_t( 1 ) << 40 ); } );
+
+        auto fill = [ &ids ] ( auto& orders ) { for ( auto i : ids ) orders.emplace( i, Order{ 1., 1. } ); return orders.size(); };
+        auto find = [] ( const auto& orders, const auto& keys )
+        {
+            auto result = 0.;
+            for ( auto key : keys )
+            {
+                auto it = orders.find( key );
+                if ( it != orders.end() )
+                    result += it->second.price;
+            }
+            return result;
+        };
+        // a random live order is cancelled, a new one is added (cancelling the oldest would favor std::hash, the identity, whose buckets then follow the ids)
+        struct Churn
+        {
+            std::vector< std::uint64_t >    live;
+            std::uint64_t                   nextId;
+            std::minstd_rand                generator;
+        };
+        auto churn = [ n ] ( auto& orders, Churn& state )
+        {
+            for ( auto i = 0; i < n; ++i )
+            {
+                auto& id = state.live[ state.generator() % state.live.size() ];
+                orders.erase( id );
+                id = state.nextId++;
+                orders.emplace( id, Order{ 1., 1. } );
+            }
+            return orders.size();
+        };
+
+        FlatHashMap< std::uint64_t, Order > flat;
+        std::unordered_map< std::uint64_t, Order > stdMap;
+        fill( flat );
+        fill( stdMap );
+
+        FlatHashMap< std::uint64_t, Order > flatChurn;
+        std::unordered_map< std::uint64_t, Order > stdChurn;
+        fill( flatChurn );
+        fill( stdChurn );
+        Churn flatState { ids, ids.back() + 1, std::minstd_rand( 42 ) };
+        Churn stdState = flatState;
+
+        tools::benchmark( n,
+            [ & ] { FlatHashMap< std::uint64_t, Order > orders; return fill( orders ); },
+            [ & ] { std::unordered_map< std::uint64_t, Order > orders; return fill( orders ); },
+            [ & ] { return find( flat, lookups ); },
+            [ & ] { return find( stdMap, lookups ); },
+            [ & ] { return find( flat, misses ); },
+            [ & ] { return find( stdMap, misses ); },
+            [ & ] { return churn( flatChurn, flatState ); },
+            [ & ] { return churn( stdChurn, stdState ); } );
+    };
+    tools::run_test< std::pair< std::uint64_t, Order > >( "flat_insert;std_insert;flat_hit;std_hit;flat_miss;std_miss;flat_churn;std_churn;", test, 1'000, 100'000, 1'000'000 );
 }
 
 BOOST_AUTO_TEST_CASE( LockBasedQueueTest )
@@ -68,6 +1024,115 @@ BOOST_AUTO_TEST_CASE( LockBasedQueueTest )
     BOOST_CHECK( q.empty() );
 }
 
+BOOST_AUTO_TEST_CASE( BoundedLockBasedQueueTest )
+{
+    {
+        LockBasedQueue< std::string > q( 2 );
+        BOOST_CHECK( q.capacity() == 2 && q.empty() );
+        BOOST_CHECK( q.tryPush( "a" ) && q.tryPush( std::string( "b" ) ) );
+
+        // full: backpressure
+        std::string c( "c" );
+        BOOST_CHECK( ! q.tryPush( c ) && c == "c" );
+        BOOST_CHECK( ! q.tryPushFor( c, std::chrono::milliseconds( 10 ) ) );
+        BOOST_CHECK( q.size() == 2 );
+
+        std::thread consumer( [ &q ] { std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) ); std::string value; q.waitAndPop( value ); } );
+        q.push( c ); // block until the consumer pops
+        consumer.join();
+
+        std::string value;
+        BOOST_CHECK( q.tryPop( value ) && value == "b" );
+        BOOST_CHECK( *q.tryPop() == "c" );
+        BOOST_CHECK( ! q.tryPop( value ) && q.tryPop() == nullptr );
+
+        // remaining elements are destroyed with the queue
+        q.push( "d" );
+    }
+
+    // many producers / consumers through a small queue, batches larger than the capacity
+    {
+        LockBasedQueue< int > q( 8 );
+        const auto nbThread = 4;
+        const auto n = 10'000;
+
+        std::vector< std::thread > threads;
+        std::atomic< long long > sum( 0 );
+        for ( auto t = 0; t < nbThread; ++t )
+        {
+            threads.emplace_back( [ &q, t, n ]
+                {
+                    std::vector< int > batch( 20 );
+                    for ( auto i = 0; i < n; i += static_cast< int >( batch.size() ) )
+                    {
+                        std::iota( batch.begin(), batch.end(), t * n + i );
+                        if ( i % 40 == 0 )
+                            q.push_n( batch.begin(), batch.end() );
+                        else
+                            for ( auto v : batch )
+                                q.push( v );
+                    }
+                } );
+            threads.emplace_back( [ &q, &sum, t, n ]
+                {
+                    long long local = 0;
+                    std::vector< int > batch( 7 );
+                    for ( auto popped = 0; popped < n; )
+                    {
+                        if ( t % 2 == 0 )
+                        {
+                            int value;
+                            q.waitAndPop( value );
+                            local += value;
+                            ++popped;
+                        }
+                        else
+                        {
+                            auto count = q.pop_n( batch.begin(), std::min< std::size_t >( batch.size(), n - popped ) );
+                            local = std::accumulate( batch.begin(), batch.begin() + count, local );
+                            popped += static_cast< int >( count );
+                        }
+                    }
+                    sum += local;
+                } );
+        }
+
+        for ( auto& thread : threads )
+            thread.join();
+
+        const auto total = static_cast< long long >( nbThread ) * n;
+        BOOST_CHECK( sum == total * ( total - 1 ) / 2 );
+        BOOST_CHECK( q.empty() );
+    }
+
+    // a construction throwing in the middle of push_n: the values already constructed stay in the queue, which is still usable
+    {
+        struct NonNegative
+        {
+            explicit NonNegative( int v ) : value( v ) { if ( v < 0 ) throw std::invalid_argument( "negative" ); }
+            int value;
+        };
+
+        for ( auto capacity : { 0, 8 } )
+        {
+            auto q = capacity == 0 ? std::make_unique< LockBasedQueue< NonNegative > >() : std::make_unique< LockBasedQueue< NonNegative > >( capacity );
+            const std::vector< int > values { 1, 2, -1, 4 };
+            BOOST_CHECK_THROW( q->push_n( values.begin(), values.end() ), std::invalid_argument );
+            BOOST_CHECK( q->size() == 2 );
+
+            const std::vector< int > next { 5, 6 };
+            q->push_n( next.begin(), next.end() );
+            q->push( NonNegative( 7 ) );
+
+            std::vector< NonNegative > popped;
+            BOOST_CHECK( q->pop_n( std::back_inserter( popped ), 10 ) == 5 && q->empty() );
+            std::vector< int > poppedValues;
+            std::transform( popped.begin(), popped.end(), std::back_inserter( poppedValues ), [] ( const auto& v ) { return v.value; } );
+            BOOST_CHECK( ( poppedValues == std::vector< int > { 1, 2, 5, 6, 7 } ) );
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE( LockFreeStackTest )
 {
     LockFreeStack< int > s;
@@ -102,4 +1167,902 @@ BOOST_AUTO_TEST_CASE( LockFreeQueueSPSCTest )
     BOOST_CHECK( q.pop() != nullptr );
 }
 
+BOOST_AUTO_TEST_CASE( RingBufferSPSCTest )
+{
+    RingBufferSPSC< std::string, 4 > q;
+    BOOST_CHECK( q.empty() );
+
+    for ( auto i = 0; i < 4; ++i )
+        BOOST_CHECK( q.emplace( 3, static_cast< char >( 'a' + i ) ) );
+    BOOST_CHECK( ! q.try_push( "full" ) );
+    BOOST_CHECK( q.size() == q.capacity() );
+
+    std::string value;
+    BOOST_CHECK( q.try_pop( value ) && value == "aaa" );
+    BOOST_CHECK( q.try_push( "eee" ) );
+    for ( auto c : { 'b', 'c', 'd', 'e' } )
+        BOOST_CHECK( q.try_pop( value ) && value == std::string( 3, c ) );
+    BOOST_CHECK( ! q.try_pop( value ) );
+
+    // wrap around several times with both sides running
+    RingBufferSPSC< int, 64 > q2;
+    const auto n = 100'000;
+    std::thread producer( [ &q2, n ] { for ( auto i = 0; i < n; ++i ) while ( ! q2.try_push( i ) ) std::this_thread::yield(); } );
+
+    auto isOrdered = true;
+    for ( auto i = 0; i < n; ++i )
+    {
+        int v;
+        while ( ! q2.try_pop( v ) )
+            std::this_thread::yield();
+        isOrdered &= v == i;
+    }
+    producer.join();
+
+    BOOST_CHECK( isOrdered );
+    BOOST_CHECK( q2.empty() );
+}
+
+namespace
+{
+    bool    spscTryPush( LockFreeQueueSPSC< int >& q, int v ) { q.push( v ); return true; }
+    bool    spscTryPop( LockFreeQueueSPSC< int >& q, int& v ) { auto p = q.pop(); if ( ! p ) return false; v = *p; return true; }
+
+    template < std::size_t N > bool spscTryPush( RingBufferSPSC< int, N >& q, int v ) { return q.try_push( v ); }
+    template < std::size_t N > bool spscTryPop( RingBufferSPSC< int, N >& q, int& v ) { return q.try_pop( v ); }
+
+    // producer and consumer pinned on different cores
+    template < typename Q >
+    long long   spscThroughput( Q& q, int n )
+    {
+        long long sum = 0;
+        std::thread producer( [ &q, n ] { tools::pinCurrentThread( 0 ); for ( auto i = 0; i < n; ++i ) while ( ! spscTryPush( q, i ) ); } );
+        std::thread consumer( [ &q, &sum, n ] { tools::pinCurrentThread( 1 ); int v; for ( auto i = 0; i < n; ++i ) { while ( ! spscTryPop( q, v ) ); sum += v; } } );
+
+        producer.join();
+        consumer.join();
+        return sum;
+    }
+
+    // ping-pong, one round trip per element
+    template < typename Q >
+    long long   spscRoundTrip( Q& ping, Q& pong, int n )
+    {
+        long long sum = 0;
+        std::thread echo( [ &ping, &pong, n ] { tools::pinCurrentThread( 1 ); int v; for ( auto i = 0; i < n; ++i ) { while ( ! spscTryPop( ping, v ) ); while ( ! spscTryPush( pong, v ) ); } } );
+        std::thread sender( [ &ping, &pong, &sum, n ] { tools::pinCurrentThread( 0 ); int v; for ( auto i = 0; i < n; ++i ) { while ( ! spscTryPush( ping, i ) ); while ( ! spscTryPop( pong, v ) ); sum += v; } } );
+
+        echo.join();
+        sender.join();
+        return sum;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( SPSCQueueBenchmark )
+{
+    auto test = [] ( auto n )
+    {
+        LockFreeQueueSPSC< int > nodeQueue, nodePing, nodePong;
+        RingBufferSPSC< int, 1024 > ringQueue, ringPing, ringPong;
+
+        double nodeThroughputT, ringThroughputT, nodeLatencyT, ringLatencyT;
+        std::tie( nodeThroughputT, ringThroughputT, nodeLatencyT, ringLatencyT ) = tools::benchmark( n,
+            // new / make_shared per push, seq_cst, head_ and tail_ on the same cache line
+            [ & ] { return spscThroughput( nodeQueue, n ); },
+            [ & ] { return spscThroughput( ringQueue, n ); },
+            [ & ] { return spscRoundTrip( nodePing, nodePong, n ); },
+            [ & ] { return spscRoundTrip( ringPing, ringPong, n ); } );
+
+        BOOST_CHECK( ringThroughputT < nodeThroughputT );
+        BOOST_CHECK( ringLatencyT < nodeLatencyT );
+    };
+    tools::run_test< int >( "nodeThroughput;ringThroughput;nodeRoundTrip;ringRoundTrip;", test, 10'000, 100'000, 1'000'000 );
+}
+
+BOOST_AUTO_TEST_CASE( BoundedQueueMPMCTest )
+{
+    BoundedQueueMPMC< int > q( 3 );
+    BOOST_CHECK( q.capacity() == 4 );
+
+    for ( auto i = 0; i < 4; ++i )
+        BOOST_CHECK( q.try_push( i ) );
+    BOOST_CHECK( ! q.try_push( 4 ) );
+    BOOST_CHECK( ! q.try_push_for( 4, std::chrono::milliseconds( 10 ) ) );
+
+    int value;
+    for ( auto i = 0; i < 4; ++i )
+        BOOST_CHECK( q.try_pop( value ) && value == i );
+    BOOST_CHECK( ! q.try_pop_for( value, std::chrono::milliseconds( 10 ) ) );
+
+    // 4 producers / 4 consumers, every value is popped exactly once
+    const auto nbThread = 4;
+    const auto n = 10'000;
+    std::vector< std::atomic< int > > popped( nbThread * n );
+    std::vector< std::thread > threads;
+    for ( auto p = 0; p < nbThread; ++p )
+        threads.emplace_back( [ &q, p, n ] { for ( auto i = 0; i < n; ++i ) q.push( p * n + i ); } );
+    for ( auto c = 0; c < nbThread; ++c )
+        threads.emplace_back( [ &q, &popped, n ] { int v; for ( auto i = 0; i < n; ++i ) { q.pop( v ); ++popped[ v ]; } } );
+
+    for ( auto& thread : threads )
+        thread.join();
+
+    BOOST_CHECK( q.empty() );
+    BOOST_CHECK( std::all_of( popped.begin(), popped.end(), [] ( const auto& c ) { return c == 1; } ) );
+
+    // a throwing construction / move assignment does not wedge the cell it claimed
+    {
+        struct Picky
+        {
+            Picky() = default;
+            explicit Picky( int v ) : value( v ) { if ( v < 0 ) throw std::invalid_argument( "negative" ); }
+            Picky( Picky&& ) = default;
+            Picky&  operator=( Picky&& other ) { if ( other.value == 13 ) throw std::runtime_error( "13" ); value = other.value; return *this; }
+
+            int value = 0;
+        };
+
+        BoundedQueueMPMC< Picky > pickyQueue( 4 );
+        Picky picky;
+        for ( auto i = 0; i < 10; ++i ) // several laps
+        {
+            BOOST_CHECK_THROW( pickyQueue.try_emplace( -1 ), std::invalid_argument );
+            BOOST_CHECK( pickyQueue.try_emplace( i ) );
+            BOOST_CHECK( pickyQueue.try_pop( picky ) && picky.value == i ); // the skipped cell is stepped over
+            BOOST_CHECK( ! pickyQueue.try_pop( picky ) );
+        }
+
+        BOOST_CHECK( pickyQueue.try_emplace( 13 ) && pickyQueue.try_emplace( 14 ) );
+        BOOST_CHECK_THROW( pickyQueue.try_pop( picky ), std::runtime_error ); // 13 is dropped
+        BOOST_CHECK( pickyQueue.try_pop( picky ) && picky.value == 14 && pickyQueue.empty() );
+
+        // destroyed with a skipped cell and an element
+        BOOST_CHECK_THROW( pickyQueue.try_emplace( -1 ), std::invalid_argument );
+        BOOST_CHECK( pickyQueue.try_emplace( 15 ) );
+    }
+}
+
+namespace
+{
+    // same number of producers and consumers, each moving n / nbThread elements
+    template < typename Push, typename Pop >
+    long long   mpmcTransfer( int n, int nbThread, Push&& push, Pop&& pop )
+    {
+        std::atomic< long long > sum( 0 );
+        std::vector< std::thread > threads;
+        for ( auto p = 0; p < nbThread; ++p )
+            threads.emplace_back( [ &push, n, nbThread ] { for ( auto i = 0; i < n / nbThread; ++i ) push( i ); } );
+        for ( auto c = 0; c < nbThread; ++c )
+            threads.emplace_back( [ &pop, &sum, n, nbThread ] { long long localSum = 0; for ( auto i = 0; i < n / nbThread; ++i ) localSum += pop(); sum += localSum; } );
+
+        for ( auto& thread : threads )
+            thread.join();
+        return sum;
+    }
+}
+
+// Many gateway threads fanning into several matcher threads
+BOOST_AUTO_TEST_CASE( MPMCQueueBenchmark )
+{
+    const auto n = 160'000;
+    std::cout << "threads;lockBased;boundedMPMC;" << std::endl;
+    for ( auto nbThread : { 1, 2, 4, 8, 16 } )
+    {
+        LockBasedQueue< int > lockBasedQueue;
+        BoundedQueueMPMC< int > boundedQueue( 1024 );
+
+        std::cout << nbThread << ";";
+        double lockBasedT, boundedT;
+        std::tie( lockBasedT, boundedT ) = tools::benchmark( n,
+            [ & ] { return mpmcTransfer( n, nbThread, [ & ] ( int v ) { lockBasedQueue.push( v ); }, [ & ] { return *lockBasedQueue.waitAndPop(); } ); },
+            [ & ] { return mpmcTransfer( n, nbThread, [ & ] ( int v ) { boundedQueue.push( v ); }, [ & ] { int v; boundedQueue.pop( v ); return v; } ); } );
+
+        BOOST_CHECK( boundedT < lockBasedT );
+    }
+}
+
+namespace
+{
+    struct Acknowledgement : MPSCQueueHook
+    {
+        int producer = 0;
+        int sequence = 0;
+    };
+}
+
+BOOST_AUTO_TEST_CASE( IntrusiveQueueMPSCTest )
+{
+    IntrusiveQueueMPSC< Acknowledgement > q;
+    BOOST_CHECK( q.empty() && q.pop() == nullptr );
+
+    const auto nbProducer = 4;
+    const auto n = 10'000;
+    std::vector< Acknowledgement > acknowledgements( nbProducer * n ); // the queue does not own the elements
+    std::vector< std::thread > producers;
+    for ( auto p = 0; p < nbProducer; ++p )
+        producers.emplace_back( [ &q, &acknowledgements, p, n ]
+            {
+                for ( auto i = 0; i < n; ++i )
+                {
+                    auto& ack = acknowledgements[ p * n + i ];
+                    ack.producer = p;
+                    ack.sequence = i;
+                    q.push( ack );
+                }
+            } );
+
+    // FIFO per producer
+    std::vector< int > nextSequence( nbProducer, 0 );
+    auto isOrdered = true;
+    auto popped = 0;
+    while ( popped < nbProducer * n )
+        popped += static_cast< int >( q.pop_all( [ & ] ( Acknowledgement& ack ) { isOrdered &= ack.sequence == nextSequence[ ack.producer ]++; } ) );
+
+    for ( auto& producer : producers )
+        producer.join();
+
+    BOOST_CHECK( isOrdered );
+    BOOST_CHECK( popped == nbProducer * n );
+    BOOST_CHECK( q.empty() && q.pop() == nullptr );
+
+    // elements can be pushed again once popped
+    q.push( acknowledgements[ 0 ] );
+    q.push( acknowledgements[ 1 ] );
+    BOOST_CHECK( q.pop() == &acknowledgements[ 0 ] );
+    BOOST_CHECK( q.pop() == &acknowledgements[ 1 ] );
+    BOOST_CHECK( q.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( BatchPushPopTest )
+{
+    std::vector< int > packet( 40 );
+    std::iota( packet.begin(), packet.end(), 0 );
+
+    std::vector< int > out;
+    auto checkFifo = [ &out, &packet ] { auto result = out == packet; out.clear(); return result; };
+
+    LockBasedQueue< int > lockBasedQueue;
+    lockBasedQueue.push_n( packet.begin(), packet.end() );
+    BOOST_CHECK( lockBasedQueue.pop_n( std::back_inserter( out ), 30 ) == 30 );
+    BOOST_CHECK( lockBasedQueue.pop_n( std::back_inserter( out ), 30 ) == 10 );
+    BOOST_CHECK( checkFifo() && lockBasedQueue.empty() );
+
+    LockFreeQueueSPSC< int > spscQueue;
+    spscQueue.push_n( packet.begin(), packet.end() );
+    BOOST_CHECK( spscQueue.pop_n( std::back_inserter( out ), 30 ) == 30 );
+    BOOST_CHECK( spscQueue.pop_n( std::back_inserter( out ), 30 ) == 10 );
+    BOOST_CHECK( checkFifo() && spscQueue.pop() == nullptr );
+
+    RingBufferSPSC< int, 32 > ringBuffer;
+    BOOST_CHECK( ringBuffer.push_n( packet.begin(), packet.end() ) == 32 ); // bounded
+    BOOST_CHECK( ringBuffer.pop_n( std::back_inserter( out ), 30 ) == 30 );
+    BOOST_CHECK( ringBuffer.push_n( packet.begin() + 32, packet.end() ) == 8 );
+    BOOST_CHECK( ringBuffer.pop_n( std::back_inserter( out ), 30 ) == 10 );
+    BOOST_CHECK( checkFifo() && ringBuffer.empty() );
+
+    LockFreeStack< int > stack;
+    stack.push( -1 );
+    stack.push_n( packet.begin(), packet.end() );
+    BOOST_CHECK( stack.pop_n( std::back_inserter( out ), 30 ) == 30 );
+    stack.push( -2 ); // on top of the remaining elements
+    BOOST_CHECK( stack.pop_n( std::back_inserter( out ), 30 ) == 12 );
+    BOOST_CHECK( stack.pop() == nullptr );
+
+    std::vector< int > expected( packet.rbegin(), packet.rbegin() + 30 );
+    expected.push_back( -2 );
+    expected.insert( expected.end(), packet.rbegin() + 30, packet.rend() );
+    expected.push_back( -1 );
+    BOOST_CHECK( out == expected );
+
+    // concurrent batches on the stack, nothing lost nor duplicated
+    LockFreeStack< int > sharedStack;
+    const auto nbThread = 4;
+    std::vector< std::atomic< int > > popped( nbThread * packet.size() );
+    std::vector< std::thread > threads;
+    for ( auto t = 0; t < nbThread; ++t )
+        threads.emplace_back( [ &sharedStack, &popped, &packet, t ]
+            {
+                std::vector< int > batch( packet.size() );
+                std::transform( packet.begin(), packet.end(), batch.begin(), [ t, &packet ] ( int i ) { return t * static_cast< int >( packet.size() ) + i; } );
+                sharedStack.push_n( batch.begin(), batch.end() );
+
+                std::vector< int > result;
+                while ( result.size() < batch.size() )
+                    sharedStack.pop_n( std::back_inserter( result ), std::min< std::size_t >( 7, batch.size() - result.size() ) );
+                for ( auto v : result )
+                    ++popped[ v ];
+            } );
+
+    for ( auto& thread : threads )
+        thread.join();
+
+    BOOST_CHECK( sharedStack.pop() == nullptr );
+    BOOST_CHECK( std::all_of( popped.begin(), popped.end(), [] ( const auto& c ) { return c == 1; } ) );
+
+    // pop() against push_n + pop_n
+    const auto rounds = 2'000;
+    std::vector< std::atomic< int > > poppedOnce( 2 * rounds * packet.size() );
+    std::atomic< bool > isDone( false );
+    threads.clear();
+    for ( auto t = 0; t < 2; ++t )
+        threads.emplace_back( [ &, t ]
+            {
+                std::vector< int > batch( packet.size() );
+                std::vector< int > result;
+                for ( auto round = 0; round < rounds; ++round )
+                {
+                    const auto first = ( t * rounds + round ) * static_cast< int >( packet.size() );
+                    std::iota( batch.begin(), batch.end(), first );
+                    sharedStack.push_n( batch.begin(), batch.end() );
+                    result.clear();
+                    sharedStack.pop_n( std::back_inserter( result ), 5 );
+                    for ( auto v : result )
+                        ++poppedOnce[ v ];
+                }
+            } );
+    for ( auto t = 0; t < 2; ++t )
+        threads.emplace_back( [ & ]
+            {
+                for ( auto isLast = false; ! isLast; )
+                {
+                    isLast = isDone;
+                    while ( auto v = sharedStack.pop() )
+                        ++poppedOnce[ *v ];
+                }
+            } );
+
+    threads[ 0 ].join();
+    threads[ 1 ].join();
+    isDone = true;
+    threads[ 2 ].join();
+    threads[ 3 ].join();
+    BOOST_CHECK( std::all_of( poppedOnce.begin(), poppedOnce.end(), [] ( const auto& c ) { return c == 1; } ) );
+
+    // stale pop(): the stack stays around one element, so a pop() often holds a head which pop_n( 1 ) takes, then a push covers it
+    // and the node below comes back on top (the head a pop() read earlier must not be published again with another next)
+    const auto staleRounds = 20'000;
+    std::vector< std::atomic< int > > poppedStale( 2 * 2 * staleRounds );
+    isDone = false;
+    threads.clear();
+    for ( auto t = 0; t < 2; ++t )
+        threads.emplace_back( [ &, t ]
+            {
+                std::vector< int > result;
+                for ( auto round = 0; round < staleRounds; ++round )
+                {
+                    const auto first = 2 * ( t * staleRounds + round );
+                    sharedStack.push( first );
+                    sharedStack.push( first + 1 );
+                    result.clear();
+                    sharedStack.pop_n( std::back_inserter( result ), 1 );
+                    for ( auto v : result )
+                        ++poppedStale[ v ];
+                }
+            } );
+    for ( auto t = 0; t < 2; ++t )
+        threads.emplace_back( [ & ]
+            {
+                for ( auto isLast = false; ! isLast; )
+                {
+                    isLast = isDone;
+                    while ( auto v = sharedStack.pop() )
+                        ++poppedStale[ *v ];
+                }
+            } );
+
+    threads[ 0 ].join();
+    threads[ 1 ].join();
+    isDone = true;
+    threads[ 2 ].join();
+    threads[ 3 ].join();
+    BOOST_CHECK( sharedStack.pop() == nullptr );
+    BOOST_CHECK( std::all_of( poppedStale.begin(), poppedStale.end(), [] ( const auto& c ) { return c == 1; } ) );
+}
+
+// Feed handler packets of 10 - 50 messages: one lock / one publication per packet instead of per message
+BOOST_AUTO_TEST_CASE( BatchPushPopBenchmark )
+{
+    auto test = [] ( auto n )
+    {
+        std::vector< int > packet( 32 );
+        std::iota( packet.begin(), packet.end(), 0 );
+        std::vector< int > out( packet.size() );
+
+        LockBasedQueue< int > lockBasedQueue;
+        LockFreeStack< int > stack;
+
+        double queueSingleT, queueBatchT, stackSingleT, stackBatchT;
+        std::tie( queueSingleT, queueBatchT, stackSingleT, stackBatchT ) = tools::benchmark( n,
+            [ & ] { auto res = 0; for ( auto i = 0; i < n; i += 32 ) { for ( auto v : packet ) lockBasedQueue.push( v ); for ( auto j = 0; j < 32; ++j ) res += *lockBasedQueue.tryPop(); } return res; },
+            [ & ] { auto res = 0; for ( auto i = 0; i < n; i += 32 ) { lockBasedQueue.push_n( packet.begin(), packet.end() ); lockBasedQueue.pop_n( out.begin(), out.size() ); res += out.back(); } return res; },
+            [ & ] { auto res = 0; for ( auto i = 0; i < n; i += 32 ) { for ( auto v : packet ) stack.push( v ); for ( auto j = 0; j < 32; ++j ) res += *stack.pop(); } return res; },
+            [ & ] { auto res = 0; for ( auto i = 0; i < n; i += 32 ) { stack.push_n( packet.begin(), packet.end() ); stack.pop_n( out.begin(), out.size() ); res += out.back(); } return res; } );
+
+        BOOST_CHECK( queueBatchT < queueSingleT );
+        BOOST_CHECK( stackBatchT < stackSingleT );
+    };
+    tools::run_test< int >( "queueSingle;queueBatch;stackSingle;stackBatch;", test, 3'200, 32'000 );
+}
+
+BOOST_AUTO_TEST_CASE( EventCountTest )
+{
+    const auto n = 10'000;
+    const auto expectedSum = static_cast< long long >( n ) * ( n - 1 ) / 2;
+
+    // consumer blocking on the node-based queue (pop returns an empty shared_ptr)
+    {
+        LockFreeQueueSPSC< int > q;
+        threading::EventCount eventCount;
+        long long sum = 0;
+        std::thread consumer( [ & ] { for ( auto i = 0; i < n; ++i ) sum += *eventCount.await( [ &q ] { return q.pop(); } ); } );
+        for ( auto i = 0; i < n; ++i )
+        {
+            if ( i % 1'000 == 0 )
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ); // let the consumer fall asleep
+            q.push( i );
+            eventCount.notify();
+        }
+        consumer.join();
+        BOOST_CHECK( sum == expectedSum );
+    }
+
+    // consumer blocking on the ring buffer (try_pop returns a bool)
+    {
+        RingBufferSPSC< int, 64 > q;
+        threading::EventCount notEmpty, notFull;
+        long long sum = 0;
+        std::thread consumer( [ & ]
+            {
+                for ( auto i = 0; i < n; ++i )
+                {
+                    int value;
+                    notEmpty.await( [ & ] { return q.try_pop( value ); } );
+                    notFull.notify();
+                    sum += value;
+                }
+            } );
+        for ( auto i = 0; i < n; ++i )
+        {
+            notFull.await( [ & ] { return q.try_push( i ); } );
+            notEmpty.notify();
+        }
+        consumer.join();
+        BOOST_CHECK( sum == expectedSum && q.empty() );
+    }
+
+    // notifyAll wakes every waiter
+    {
+        std::atomic< bool > isReady( false );
+        threading::EventCount eventCount;
+        std::atomic< int > awoken( 0 );
+        std::vector< std::thread > waiters;
+        for ( auto i = 0; i < 4; ++i )
+            waiters.emplace_back( [ & ] { eventCount.await( [ & ] { return isReady.load(); } ); ++awoken; } );
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        isReady = true;
+        eventCount.notifyAll();
+        for ( auto& waiter : waiters )
+            waiter.join();
+        BOOST_CHECK( awoken == 4 );
+    }
+}
+
+namespace
+{
+    // Every thread pushes then pops (the stack is never empty when popping), sample is called by each thread once done (still alive)
+    template < typename Push, typename Pop, typename Sample >
+    long long   stackContention( int n, int nbThread, Push&& push, Pop&& pop, Sample&& sample )
+    {
+        std::atomic< long long > sum( 0 );
+        std::vector< std::thread > threads;
+        for ( auto t = 0; t < nbThread; ++t )
+            threads.emplace_back( [ &, n, nbThread ] { long long localSum = 0; for ( auto i = 0; i < n / nbThread; ++i ) { push( i ); localSum += pop(); } sum += localSum; sample(); } );
+
+        for ( auto& thread : threads )
+            thread.join();
+        return sum;
+    }
+
+    template < typename Reclamation >
+    void    checkReclaimingLockFreeStack()
+    {
+        ReclaimingLockFreeStack< std::string, Reclamation > s;
+        std::string value;
+        BOOST_CHECK( s.empty() && ! s.pop( value ) );
+
+        s.push( "a" );
+        s.emplace( 2, 'b' );
+        BOOST_CHECK( s.pop( value ) && value == "bb" );
+        BOOST_CHECK( s.pop( value ) && value == "a" );
+        BOOST_CHECK( s.empty() );
+
+        ReclaimingLockFreeStack< int, Reclamation > intStack;
+        const auto n = 40'000;
+        const auto nbThread = 4;
+        auto sum = stackContention( n, nbThread, [ &intStack ] ( int v ) { intStack.push( v ); }, [ &intStack ] { int v = -1; intStack.pop( v ); return v; }, [] {} );
+        BOOST_CHECK( sum == nbThread * ( static_cast< long long >( n / nbThread ) * ( n / nbThread - 1 ) / 2 ) );
+        BOOST_CHECK( intStack.empty() );
+
+        s.push( "left in the stack" ); // deleted by the destructor
+    }
+}
+
+BOOST_AUTO_TEST_CASE( ReclaimingLockFreeStackTest )
+{
+    checkReclaimingLockFreeStack< threading::HazardPointers >();
+    checkReclaimingLockFreeStack< threading::EpochReclamation >();
+}
+
+// Throughput of push / pop pairs under contention, and the memory overhead as the peak number of nodes retired but not reclaimed yet
+BOOST_AUTO_TEST_CASE( ReclamationBenchmark )
+{
+    const auto n = 160'000;
+    std::cout << "threads;referenceCounting;hazardPointers;epochs;hazardPointersPeakRetired;epochsPeakRetired;" << std::endl;
+    for ( auto nbThread : { 1, 2, 4, 8, 16 } )
+    {
+        LockFreeStack< int > referenceCountingStack;
+        ReclaimingLockFreeStack< int, threading::HazardPointers > hazardPointersStack;
+        ReclaimingLockFreeStack< int, threading::EpochReclamation > epochsStack;
+
+        std::atomic< std::size_t > hazardPointersPeak( 0 ), epochsPeak( 0 );
+        auto samplePeak = [] ( std::atomic< std::size_t >& peak, std::size_t pending )
+        {
+            for ( auto current = peak.load(); current < pending && ! peak.compare_exchange_weak( current, pending ); );
+        };
+
+        std::cout << nbThread << ";";
+        tools::benchmark( n,
+            [ & ] { return stackContention( n, nbThread, [ & ] ( int v ) { referenceCountingStack.push( v ); }, [ & ] { return *referenceCountingStack.pop(); }, [] {} ); },
+            [ & ] { return stackContention( n, nbThread, [ & ] ( int v ) { hazardPointersStack.push( v ); }, [ & ] { int v = 0; hazardPointersStack.pop( v ); return v; },
+                                            [ & ] { samplePeak( hazardPointersPeak, threading::HazardPointers::pendingCount() ); } ); },
+            [ & ] { return stackContention( n, nbThread, [ & ] ( int v ) { epochsStack.push( v ); }, [ & ] { int v = 0; epochsStack.pop( v ); return v; },
+                                            [ & ] { samplePeak( epochsPeak, threading::EpochReclamation::pendingCount() ); } ); } );
+        std::cout << ";;;;" << hazardPointersPeak << ";" << epochsPeak << ";" << std::endl;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( EliminationBackoffStackTest )
+{
+    EliminationBackoffStack< std::string > s;
+    std::string value;
+    BOOST_CHECK( s.empty() && ! s.pop( value ) );
+
+    s.push( "a" );
+    s.emplace( 2, 'b' );
+    BOOST_CHECK( s.pop( value ) && value == "bb" );
+    BOOST_CHECK( s.pop( value ) && value == "a" );
+    BOOST_CHECK( s.empty() );
+
+    // enough threads for the collisions to go through the elimination array
+    EliminationBackoffStack< int, threading::EpochReclamation > intStack;
+    const auto n = 80'000;
+    const auto nbThread = 16;
+    auto sum = stackContention( n, nbThread, [ &intStack ] ( int v ) { intStack.push( v ); }, [ &intStack ] { int v = -1; intStack.pop( v ); return v; }, [] {} );
+    BOOST_CHECK( sum == nbThread * ( static_cast< long long >( n / nbThread ) * ( n / nbThread - 1 ) / 2 ) );
+    BOOST_CHECK( intStack.empty() );
+}
+
+// Shared free list of buffers: every thread takes a buffer and gives it back
+BOOST_AUTO_TEST_CASE( EliminationBackoffStackBenchmark )
+{
+    const auto n = 240'000;
+    std::cout << "threads;treiber;eliminationBackoff;" << std::endl;
+    for ( auto nbThread : { 1, 2, 4, 8, 16, 24 } )
+    {
+        ReclaimingLockFreeStack< int > treiberStack;
+        EliminationBackoffStack< int > eliminationStack;
+
+        std::cout << nbThread << ";";
+        double treiberT, eliminationT;
+        std::tie( treiberT, eliminationT ) = tools::benchmark( n,
+            [ & ] { return stackContention( n, nbThread, [ & ] ( int v ) { treiberStack.push( v ); }, [ & ] { int v = 0; treiberStack.pop( v ); return v; }, [] {} ); },
+            [ & ] { return stackContention( n, nbThread, [ & ] ( int v ) { eliminationStack.push( v ); }, [ & ] { int v = 0; eliminationStack.pop( v ); return v; }, [] {} ); } );
+
+        if ( nbThread >= 8 )
+            BOOST_CHECK( eliminationT < treiberT );
+    }
+}
+
+namespace
+{
+    struct MarketData
+    {
+        long long   price = 0;
+        bool        isJournaled = false; // written by the journaler, read by the consumers depending on it
+    };
+
+    // Consume every sequence up to last through barrier, call f( T& ) for each then release them with sequence
+    template < typename RingBuffer, typename Barrier, typename F >
+    void    consumeUntil( RingBuffer& ringBuffer, const Barrier& barrier, Sequence& sequence, std::int64_t last, F&& f )
+    {
+        for ( auto next = sequence.get() + 1; next <= last; )
+        {
+            auto available = barrier.waitFor( next );
+            for ( ; next <= available; ++next )
+                f( ringBuffer[ next ] );
+            sequence.set( available );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( MulticastRingBufferTest )
+{
+    MulticastRingBuffer< MarketData, 8 > ringBuffer; // small, the producer laps the consumers many times
+    const auto n = 100'000;
+    const auto expectedSum = static_cast< long long >( n ) * ( n - 1 ) / 2;
+
+    // journaler and strategy read every message, risk waits for the journaler to be done with a message
+    Sequence journalerSequence, strategySequence, riskSequence;
+    ringBuffer.addGatingSequence( strategySequence );
+    ringBuffer.addGatingSequence( riskSequence ); // journaler is gating through risk
+
+    auto consumerBarrier = ringBuffer.newBarrier();
+    auto riskBarrier = ringBuffer.newBarrier( { &journalerSequence } );
+
+    long long journalerSum = 0, strategySum = 0, riskSum = 0;
+    auto isJournaled = true;
+    std::thread journaler( [ & ] { consumeUntil( ringBuffer, consumerBarrier, journalerSequence, n - 1, [ & ] ( MarketData& m ) { journalerSum += m.price; m.isJournaled = true; } ); } );
+    std::thread strategy( [ & ] { consumeUntil( ringBuffer, consumerBarrier, strategySequence, n - 1, [ & ] ( const MarketData& m ) { strategySum += m.price; } ); } );
+    std::thread risk( [ & ] { consumeUntil( ringBuffer, riskBarrier, riskSequence, n - 1, [ & ] ( const MarketData& m ) { riskSum += m.price; isJournaled &= m.isJournaled; } ); } );
+
+    for ( auto i = 0; i < n; ++i )
+        ringBuffer.publishWith( [ i ] ( MarketData& m ) { m.price = i; m.isJournaled = false; } );
+
+    journaler.join();
+    strategy.join();
+    risk.join();
+
+    BOOST_CHECK( journalerSum == expectedSum && strategySum == expectedSum && riskSum == expectedSum );
+    BOOST_CHECK( isJournaled );
+    BOOST_CHECK( ringBuffer.cursor().get() == n - 1 );
+
+    // the producer cannot overtake the slowest consumer
+    std::int64_t sequence = 0;
+    for ( auto i = 0u; i < ringBuffer.capacity(); ++i )
+    {
+        BOOST_CHECK( ringBuffer.tryClaim( sequence ) );
+        ringBuffer.publish( sequence );
+    }
+    BOOST_CHECK( ! ringBuffer.tryClaim( sequence ) );
+    strategySequence.set( strategySequence.get() + 1 );
+    BOOST_CHECK( ! ringBuffer.tryClaim( sequence ) );
+    riskSequence.set( riskSequence.get() + 1 );
+    BOOST_CHECK( ringBuffer.tryClaim( sequence ) && sequence == n + static_cast< std::int64_t >( ringBuffer.capacity() ) );
+}
+
+// One producer fanning out to 3 consumers: one copy read in place by everybody vs one copy per consumer queue
+BOOST_AUTO_TEST_CASE( MulticastRingBufferBenchmark )
+{
+    struct Message
+    {
+        long long   sequence;
+        char        payload[ 120 ];
+    };
+
+    auto test = [] ( auto n )
+    {
+        const auto nbConsumer = 3;
+
+        double multicastT, queuePerConsumerT;
+        std::tie( multicastT, queuePerConsumerT ) = tools::benchmark( n,
+            [ n ]
+            {
+                auto ringBuffer = std::make_unique< MulticastRingBuffer< Message, 1024 > >();
+                std::vector< Sequence > sequences( nbConsumer );
+                for ( auto& sequence : sequences )
+                    ringBuffer->addGatingSequence( sequence );
+                auto barrier = ringBuffer->newBarrier();
+
+                std::atomic< long long > sum( 0 );
+                std::vector< std::thread > consumers;
+                for ( auto& sequence : sequences )
+                    consumers.emplace_back( [ &, n ] { long long local = 0; consumeUntil( *ringBuffer, barrier, sequence, n - 1, [ &local ] ( const Message& m ) { local += m.sequence; } ); sum += local; } );
+
+                for ( auto i = 0; i < n; ++i )
+                    ringBuffer->publishWith( [ i ] ( Message& m ) { m.sequence = i; } );
+                for ( auto& consumer : consumers )
+                    consumer.join();
+                return sum.load();
+            },
+            [ n ]
+            {
+                std::vector< std::unique_ptr< RingBufferSPSC< Message, 1024 > > > queues;
+                for ( auto c = 0; c < nbConsumer; ++c )
+                    queues.push_back( std::make_unique< RingBufferSPSC< Message, 1024 > >() );
+
+                std::atomic< long long > sum( 0 );
+                std::vector< std::thread > consumers;
+                for ( auto& queue : queues )
+                    consumers.emplace_back( [ &, n ] { long long local = 0; Message m; for ( auto i = 0; i < n; ++i ) { while ( ! queue->try_pop( m ) ); local += m.sequence; } sum += local; } );
+
+                Message m{};
+                for ( auto i = 0; i < n; ++i )
+                {
+                    m.sequence = i;
+                    for ( auto& queue : queues )
+                        while ( ! queue->try_push( m ) );
+                }
+                for ( auto& consumer : consumers )
+                    consumer.join();
+                return sum.load();
+            } );
+
+        BOOST_CHECK( multicastT < queuePerConsumerT );
+    };
+    tools::run_test< int >( "multicast;queuePerConsumer;", test, 10'000, 100'000, 1'000'000 );
+}
+
+namespace
+{
+    template < typename Reclamation >
+    void    checkConcurrentHashMap()
+    {
+        ConcurrentHashMap< int, int, generics::FastHash, std::equal_to< int >, Reclamation > m( 0, 1 ); // a single segment, grown from its minimal capacity
+        int value = -1;
+        BOOST_CHECK( m.empty() && ! m.find( 1, value ) && ! m.erase( 1 ) );
+        BOOST_CHECK( m.insert( 1, 10 ) && ! m.insert( 1, 11 ) && m.find( 1, value ) && value == 10 );
+        BOOST_CHECK( ! m.insert_or_assign( 1, 12 ) && m.find( 1, value ) && value == 12 && m.insert_or_assign( 2, 20 ) && m.size() == 2 );
+        BOOST_CHECK( m.erase( 1 ) && ! m.contains( 1 ) && m.contains( 2 ) && m.size() == 1 );
+
+        // growth, then churn (the tombstones are reclaimed by the rehashes in place)
+        for ( auto i = 0; i < 10'000; ++i )
+            m.insert( i, 2 * i );
+        for ( auto round = 0; round < 10; ++round )
+            for ( auto i = 0; i < 10'000; i += 2 )
+                BOOST_CHECK( m.erase( i ) && m.insert( i, 3 * i ) );
+        auto isExpected = true;
+        for ( auto i = 0; i < 10'000; ++i )
+            isExpected &= m.find( i, value ) && value == ( i % 2 == 0 ? 3 * i : 2 * i );
+        BOOST_CHECK( isExpected && m.size() == 10'000 && ! m.contains( 10'000 ) );
+
+        // the writers churn their own keys (erase, insert, assign) while the readers check that a value found is the one of its key (value >> 32)
+        // and that the keys never erased are always found, through the segment growths
+        ConcurrentHashMap< int, std::uint64_t, generics::FastHash, std::equal_to< int >, Reclamation > shared( 0, 4 );
+        const auto stableKeys = 1'000;
+        for ( auto key = 0; key < stableKeys; ++key )
+            shared.insert( key, static_cast< std::uint64_t >( key ) << 32 );
+
+        const auto nbWriter = 3;
+        const auto keysPerWriter = 5'000;
+        std::atomic< bool > stop( false );
+        std::atomic< int > errors( 0 );
+        std::vector< std::thread > threads;
+        for ( auto w = 0; w < nbWriter; ++w )
+            threads.emplace_back( [ &, w ]
+                {
+                    const auto first = stableKeys + w * keysPerWriter;
+                    for ( std::uint64_t round = 0; round < 4; ++round )
+                        for ( auto key = first; key < first + keysPerWriter; ++key )
+                        {
+                            const auto v = ( static_cast< std::uint64_t >( key ) << 32 ) | round;
+                            if ( round > 0 && ! shared.erase( key ) )
+                                ++errors;
+                            if ( ! shared.insert( key, v ) || shared.insert_or_assign( key, v + 1 ) )
+                                ++errors;
+                        }
+                } );
+        for ( auto r = 0; r < 2; ++r )
+            threads.emplace_back( [ &, r ]
+                {
+                    std::mt19937 generator( r );
+                    std::uniform_int_distribution< int > keys( 0, stableKeys + nbWriter * keysPerWriter - 1 );
+                    std::uint64_t v;
+                    while ( ! stop )
+                    {
+                        const auto key = keys( generator );
+                        const auto isFound = shared.find( key, v );
+                        if ( ( isFound && ( v >> 32 ) != static_cast< std::uint64_t >( key ) ) || ( ! isFound && key < stableKeys ) )
+                            ++errors;
+                    }
+                } );
+
+        for ( auto w = 0; w < nbWriter; ++w )
+            threads[ w ].join();
+        stop = true;
+        for ( auto t = nbWriter; t < static_cast< int >( threads.size() ); ++t )
+            threads[ t ].join();
+
+        BOOST_CHECK( errors == 0 && shared.size() == static_cast< std::size_t >( stableKeys + nbWriter * keysPerWriter ) );
+        std::uint64_t v;
+        BOOST_CHECK( shared.find( stableKeys, v ) && v == ( ( static_cast< std::uint64_t >( stableKeys ) << 32 ) | 4 ) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( ConcurrentHashMapTest )
+{
+    checkConcurrentHashMap< threading::EpochReclamation >();
+    checkConcurrentHashMap< threading::HazardPointers >();
+
+    using Map = ConcurrentHashMap< std::uint64_t, double >;
+    Map m( 1'000 );
+    BOOST_CHECK( m.segmentCount() == Map::DefaultSegmentCount );
+    for ( std::uint64_t i = 0; i < 1'000; ++i )
+        m.insert( i, i / 2. );
+    double value;
+    BOOST_CHECK( m.size() == 1'000 && m.find( 999, value ) && value == 499.5 );
+}
+
+namespace
+{
+    // FIX MsgType (tag 35) values
+    constexpr auto FixMessageTypes = makePerfectHashMap< std::string_view, int >( { { "0", 0 }, { "1", 1 }, { "2", 2 }, { "3", 3 }, { "4", 4 }, { "5", 5 }, { "8", 8 },
+                                                                                    { "9", 9 }, { "A", 10 }, { "D", 13 }, { "F", 15 }, { "G", 16 }, { "H", 17 }, { "V", 31 },
+                                                                                    { "W", 32 }, { "X", 33 }, { "j", 45 }, { "AE", 100 } } );
+
+    // FIX tags to their name
+    constexpr auto FixTags = makePerfectHashMap< int, std::string_view >( { { 8, "BeginString" }, { 9, "BodyLength" }, { 10, "CheckSum" }, { 11, "ClOrdID" },
+                                                                            { 35, "MsgType" }, { 38, "OrderQty" }, { 44, "Price" }, { 49, "SenderCompID" },
+                                                                            { 54, "Side" }, { 55, "Symbol" }, { 56, "TargetCompID" } } );
+
+    constexpr std::string_view Symbols[] = { "AAPL", "MSFT", "AMZN", "GOOGL", "GOOG", "META", "NVDA", "TSLA", "BRK.B", "JPM", "JNJ", "V", "PG", "UNH", "HD", "MA",
+                                             "XOM", "CVX", "BAC", "PFE", "KO", "PEP", "ABBV", "AVGO", "COST", "MRK", "TMO", "WMT", "DIS", "CSCO", "ACN", "ABT",
+                                             "MCD", "ADBE", "CRM", "NFLX", "DHR", "LIN", "VZ", "CMCSA", "TXN", "NKE", "WFC", "PM", "NEE", "BMY", "RTX", "ORCL",
+                                             "AMD", "UPS", "QCOM", "HON", "INTC", "T", "LOW", "SPGI", "IBM", "AMGN", "CAT", "GS", "SBUX", "INTU", "BA", "GE" };
+
+    constexpr auto SymbolIndexes = makePerfectHashIndex( Symbols );
+}
+
+// The tables are built by the compiler
+static_assert( *FixMessageTypes.find( "D" ) == 13 && FixMessageTypes.at( "AE" ) == 100 && ! FixMessageTypes.contains( "Z" ) && ! FixMessageTypes.contains( "" ) );
+static_assert( FixTags.at( 35 ) == "MsgType" && FixTags.find( 36 ) == nullptr );
+static_assert( SymbolIndexes.at( "AAPL" ) == 0 && SymbolIndexes.at( "GE" ) == 63 && ! SymbolIndexes.contains( "GOO" ) );
+
+BOOST_AUTO_TEST_CASE( PerfectHashMapTest )
+{
+    // found with the runtime hash, and from a std::string (transparent lookup)
+    auto isExpected = true;
+    for ( std::size_t i = 0; i < std::size( Symbols ); ++i )
+        isExpected &= SymbolIndexes.at( std::string( Symbols[ i ] ) ) == i && SymbolIndexes.count( Symbols[ i ] ) == 1;
+    BOOST_CHECK( isExpected && SymbolIndexes.size() == 64 );
+    BOOST_CHECK( ! SymbolIndexes.contains( std::string( "AAPL " ) ) && ! FixMessageTypes.contains( "DD" ) && FixTags.at( 55 ) == "Symbol" );
+    BOOST_CHECK_THROW( FixTags.at( 12 ), std::out_of_range );
+
+    auto count = 0;
+    FixMessageTypes.forEach( [ &count ] ( std::string_view type, int value ) { count += FixMessageTypes.at( type ) == value; } );
+    BOOST_CHECK( count == 18 );
+
+    // built at runtime too, then every key is placed in a single probe
+    std::array< std::pair< std::uint64_t, std::uint64_t >, 5'000 > entries;
+    for ( std::uint64_t i = 0; i < entries.size(); ++i )
+        entries[ i ] = std::make_pair( i * 7'919, i );
+    auto large = std::make_unique< PerfectHashMap< std::uint64_t, std::uint64_t, 5'000 > >( entries );
+    isExpected = true;
+    for ( std::uint64_t i = 0; i < entries.size(); ++i )
+        isExpected &= large->at( i * 7'919 ) == i && ( i % 7'919 == 0 || ! large->contains( i ) );
+    BOOST_CHECK( isExpected );
+
+    BOOST_CHECK_THROW( makePerfectHashIndex< int >( { 1, 2, 3, 2 } ), std::invalid_argument );
+}
+
+// Lookups of random symbols among 64 (always found)
+BOOST_AUTO_TEST_CASE( PerfectHashMapBenchmark )
+{
+    FlatHashMap< std::string_view, std::size_t > flatHashMap;
+    std::unordered_map< std::string_view, std::size_t > unorderedMap;
+    for ( std::size_t i = 0; i < std::size( Symbols ); ++i )
+    {
+        flatHashMap.emplace( Symbols[ i ], i );
+        unorderedMap.emplace( Symbols[ i ], i );
+    }
+
+    auto test = [ & ] ( auto n )
+    {
+        std::mt19937 generator( 42 );
+        std::uniform_int_distribution< std::size_t > symbols( 0, std::size( Symbols ) - 1 );
+        std::vector< std::string_view > queries( n );
+        for ( auto& query : queries )
+            query = Symbols[ symbols( generator ) ];
+
+        double perfectT, flatT, unorderedT;
+        std::tie( perfectT, flatT, unorderedT ) = tools::benchmark( n,
+            [ & ] { std::size_t sum = 0; for ( auto query : queries ) sum += *SymbolIndexes.find( query ); return sum; },
+            [ & ] { std::size_t sum = 0; for ( auto query : queries ) sum += flatHashMap.find( query )->second; return sum; },
+            [ & ] { std::size_t sum = 0; for ( auto query : queries ) sum += unorderedMap.find( query )->second; return sum; } );
+
+        BOOST_CHECK( perfectT < flatT && perfectT < unorderedT );
+    };
+    tools::run_test< std::string_view >( "perfectHashMap;flatHashMap;unorderedMap;", test, 1'000, 100'000 );
+}
+
 BOOST_AUTO_TEST_SUITE_END() // CustomContainerTesSuite
@@ -0,0 +1,200 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "generic/FastHash.h"
+#include "generic/HashCombine.h"
+#include "tools/Benchmark.h"
+
+BOOST_AUTO_TEST_SUITE( HashQualityTestSuite )
+
+namespace
+{
+    // Strict avalanche criterion: flipping any input bit flips each output bit with a probability of 1 / 2
+    // Largest distance to 1 / 2 over the ( input bit, output bit ) pairs, for samples random inputs of size bytes
+    // (the input bits are sampled for the long inputs)
+    template < typename Hash >
+    double  avalancheMaxBias( std::size_t size, int samples, Hash hash )
+    {
+        const auto inputBits = size * 8;
+        const auto bitStep = std::max< std::size_t >( 1, inputBits / 512 );
+        std::vector< std::array< int, 64 > > flips( ( inputBits + bitStep - 1 ) / bitStep, std::array< int, 64 > {} );
+
+        std::mt19937_64 generator( 42 );
+        std::vector< unsigned char > input( size );
+        for ( auto sample = 0; sample < samples; ++sample )
+        {
+            std::generate( input.begin(), input.end(), [ &generator ] { return static_cast< unsigned char >( generator() ); } );
+            const std::uint64_t reference = hash( input );
+            for ( std::size_t bit = 0, row = 0; bit < inputBits; bit += bitStep, ++row )
+            {
+                input[ bit / 8 ] ^= 1 << ( bit % 8 );
+                const auto diff = reference ^ static_cast< std::uint64_t >( hash( input ) );
+                input[ bit / 8 ] ^= 1 << ( bit % 8 );
+                for ( std::size_t out = 0; out < 64; ++out )
+                    flips[ row ][ out ] += ( diff >> out ) & 1;
+            }
+        }
+
+        auto result = 0.;
+        for ( const auto& row : flips )
+            for ( auto count : row )
+                result = std::max( result, std::abs( static_cast< double >( count ) / samples - .5 ) );
+        return result;
+    }
+
+    std::uint64_t   readInteger( const std::vector< unsigned char >& input )
+    {
+        std::uint64_t result = 0;
+        std::memcpy( &result, input.data(), sizeof( result ) );
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( FastHashAvalancheTest )
+{
+    // 1000 samples: the bias of a perfect hash is below 0.1 with a very high probability, even over 512 x 64 pairs
+    const auto samples = 1'000;
+    const auto threshold = .1;
+
+    BOOST_CHECK( avalancheMaxBias( 8, samples, [] ( const auto& input ) { return generics::hashInteger( readInteger( input ) ); } ) < threshold );
+    BOOST_CHECK( avalancheMaxBias( 8, samples, [] ( const auto& input ) { return generics::FastHash()( readInteger( input ) ); } ) < threshold );
+
+    // every path of hashBytes: 1 to 3 bytes, 4 to 16, up to 48, the three chains, the bulk (partial block, several blocks)
+    for ( std::size_t size : { 3, 8, 16, 40, 100, 300, 2'000 } )
+    {
+        const auto bias = avalancheMaxBias( size, samples, [] ( const auto& input ) { return generics::hashBytes( input.data(), input.size() ); } );
+        BOOST_TEST_MESSAGE( "hashBytes( " << size << " bytes ) max bias " << bias );
+        BOOST_CHECK( bias < threshold );
+    }
+
+    // std::hash of an integer is the identity on libstdc++: an input bit flips a single output bit
+    if ( std::hash< std::uint64_t >()( 12345 ) == 12345 )
+        BOOST_CHECK( avalancheMaxBias( 8, samples, [] ( const auto& input ) { return std::hash< std::uint64_t >()( readInteger( input ) ); } ) == .5 );
+}
+
+BOOST_AUTO_TEST_CASE( FastHashTest )
+{
+    // the SSE2 and scalar bulk paths are the same hash
+    std::mt19937_64 generator( 42 );
+    std::vector< unsigned char > buffer( 5'000 );
+    std::generate( buffer.begin(), buffer.end(), [ &generator ] { return static_cast< unsigned char >( generator() ); } );
+    for ( std::size_t size = generics::details::BulkThreshold + 1; size < buffer.size(); size += 97 )
+        BOOST_CHECK( generics::hashBytes( buffer.data(), size ) == ( generics::details::hashLong< generics::details::accumulateScalar, generics::details::scrambleScalar >( buffer.data(), size, 0 ) ) );
+
+    // each size is hashed differently (a prefix is not a collision), the seed changes the hash
+    std::vector< std::uint64_t > prefixes;
+    for ( std::size_t size = 0; size < 600; ++size )
+        prefixes.push_back( generics::hashBytes( buffer.data(), size ) );
+    std::sort( prefixes.begin(), prefixes.end() );
+    BOOST_CHECK( std::adjacent_find( prefixes.begin(), prefixes.end() ) == prefixes.end() );
+    BOOST_CHECK( generics::hashBytes( buffer.data(), 20, 1 ) != generics::hashBytes( buffer.data(), 20, 2 ) );
+    BOOST_CHECK( generics::hashInteger( 5, 1 ) != generics::hashInteger( 5, 2 ) );
+
+    // transparent: the strings are hashed as bytes whatever their type
+    const std::string order = "ORDER-123456";
+    generics::FastHash hash;
+    BOOST_CHECK( hash( order ) == hash( std::string_view( order ) ) && hash( order ) == hash( "ORDER-123456" ) && hash( order ) == hash( order.c_str() ) );
+    BOOST_CHECK( hash( 0. ) == hash( -0. ) && hash( 1. ) != hash( 2. ) && hash( 1 ) == hash( 1ULL ) );
+    BOOST_CHECK( hash( std::bitset< 8 >( 5 ) ) == generics::hashInteger( std::hash< std::bitset< 8 > >()( std::bitset< 8 >( 5 ) ) ) ); // any other type
+
+    // drop-in Hasher of hashCombineGeneric
+    const auto combined = generics::hashCombineGeneric< generics::FastHasher >( 5, order, 2. );
+    BOOST_CHECK( combined == generics::hashCombineGeneric< generics::FastHasher >( 5, order, 2. ) );
+    BOOST_CHECK( combined != generics::hashCombineGeneric< generics::FastHasher >( 2., order, 5 ) );
+
+    // sequential keys are spread over the low bits (the bucket of a power of 2 table)
+    std::array< int, 1'024 > buckets {};
+    for ( std::uint64_t i = 0; i < 1'024 * 64; ++i )
+        ++buckets[ hash( i ) & ( buckets.size() - 1 ) ];
+    const auto minMax = std::minmax_element( buckets.begin(), buckets.end() );
+    BOOST_CHECK( *minMax.first > 64 / 2 && *minMax.second < 64 * 2 );
+}
+
+// Hashed by the compiler, to the runtime value
+static_assert( generics::hashString( "ORDER-123456" ) == generics::FastHash()( "ORDER-123456" ) && generics::hashString( "a", 1 ) != generics::hashString( "a", 2 ) );
+static_assert( generics::FastHash()( 35 ) == generics::hashInteger( 35 ) && generics::hashInteger( 35 ) != generics::hashInteger( 36 ) );
+static_assert( generics::hashCombineGeneric< generics::FastHasher >( 35, std::string_view( "D" ) ) != generics::hashCombineGeneric< generics::FastHasher >( 35, std::string_view( "F" ) ) );
+
+namespace
+{
+    // every path of hashShort, evaluated by the compiler
+    template < std::size_t... Sizes >
+    constexpr auto  constexprStringHashes( std::index_sequence< Sizes... > )
+    {
+        constexpr const char text[] = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, "
+                                      "quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in voluptate";
+        return std::array< std::uint64_t, sizeof...( Sizes ) > { { generics::hashString( std::string_view( text, Sizes * 7 ), Sizes ) ... } };
+    }
+}
+
+BOOST_AUTO_TEST_CASE( ConstexprHashTest )
+{
+    constexpr const char text[] = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, "
+                                  "quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in voluptate";
+    constexpr auto hashes = constexprStringHashes( std::make_index_sequence< 37 >() ); // 0 to 252 bytes
+
+    auto isEqual = true;
+    for ( std::size_t i = 0; i < hashes.size(); ++i )
+        isEqual &= hashes[ i ] == generics::hashBytes( text, i * 7, i );
+    BOOST_CHECK( isEqual );
+
+    // the runtime composition of constexpr hashes
+    constexpr auto key = generics::hashCombineGeneric< generics::FastHasher >( 35, std::string_view( "D" ), 55ULL );
+    BOOST_CHECK( key == generics::hashCombineGeneric< generics::FastHasher >( 35, std::string( "D" ), 55 ) );
+    constexpr auto mixed = generics::Hash128to64( 1, 2 );
+    BOOST_CHECK( mixed == generics::Hash128to64( 1, 2 ) );
+}
+
+BOOST_AUTO_TEST_CASE( FastHashBenchmark )
+{
+    // time per byte, keys of n bytes
+    auto test = [] ( auto n )
+    {
+        const std::size_t keyCount = std::max< std::size_t >( 1, 1'000'000 / n );
+        std::vector< char > buffer( n + keyCount );
+        std::mt19937 generator( 42 );
+        std::generate( buffer.begin(), buffer.end(), [ &generator ] { return static_cast< char >( generator() ); } );
+
+        auto hashKeys = [ & ] ( auto hash )
+        {
+            std::uint64_t result = 0;
+            for ( std::size_t i = 0; i < keyCount; ++i )
+                result += hash( std::string_view( buffer.data() + i, n ) );
+            return result;
+        };
+
+        tools::benchmark( n * keyCount,
+            [ & ] { return hashKeys( generics::FastHash() ); },
+            [ & ] { return hashKeys( std::hash< std::string_view >() ); },
+            [ & ] { return hashKeys( [] ( std::string_view s ) { return s.size() > generics::details::BulkThreshold
+                                                                           ? generics::details::hashLong< generics::details::accumulateScalar, generics::details::scrambleScalar >( reinterpret_cast< const unsigned char* >( s.data() ), s.size(), 0 )
+                                                                           : generics::hashBytes( s.data(), s.size() ); } ); } );
+    };
+    tools::run_test< char >( "fastHash;std::hash;fastHash_scalar;", test, 8, 16, 32, 64, 256, 1'024, 16'384, 262'144 );
+
+    // time per integer
+    auto testIntegers = [] ( auto n )
+    {
+        tools::benchmark( n,
+            [ n ] { std::uint64_t result = 0; for ( std::uint64_t i = 0; i < static_cast< std::uint64_t >( n ); ++i ) result += generics::hashInteger( i ); return result; },
+            [ n ] { std::uint64_t result = 0; for ( std::uint64_t i = 0; i < static_cast< std::uint64_t >( n ); ++i ) result += generics::Hash128to64( i, 0x9E3779B97F4A7C15ULL ); return result; },
+            [ n ] { std::uint64_t result = 0; for ( std::uint64_t i = 0; i < static_cast< std::uint64_t >( n ); ++i ) result += std::hash< std::uint64_t >()( i ); return result; } );
+    };
+    tools::run_test< std::uint64_t >( "hashInteger;Hash128to64;std::hash;", testIntegers, 1'000'000 );
+}
+
+BOOST_AUTO_TEST_SUITE_END() // HashQualityTestSuite
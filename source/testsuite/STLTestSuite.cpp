@@ -312,10 +312,13 @@ namespace
     using OrderId = size_t;
     using OrderT = size_t;
 
+    // Smallest power of 8 not below n (1 for 0), i.e. the bucket count of the first growth steps
     size_t     nearest_power_8( size_t n )
     {
-        // TODO
-        return n;
+        size_t result = 1;
+        while ( result < n )
+            result *= 8;
+        return result;
     }
 }
 
@@ -326,6 +329,7 @@ BOOST_AUTO_TEST_CASE( UnorderedMapStatTest )
     //m.reserve( 7 ); // whatever happen, it will reserve nearest power of 2 (except if too small then it will use nearest power of 8 in vs2015)
 
     // might be better to reserve upfront nearest power of 8 to diminish the collision and keep consistent with the default hash policy
+    BOOST_CHECK( nearest_power_8( 7 ) == 8 && nearest_power_8( 8 ) == 8 && nearest_power_8( 9 ) == 64 );
     m.reserve( nearest_power_8( 7 ) );
 
     for ( auto i = 0; i < 10; ++i )
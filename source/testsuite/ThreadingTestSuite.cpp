@@ -16,8 +16,15 @@
 #include <numeric>
 #include <queue>
 #include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <random>
 
+#include "containers/ConcurrentHashMap.h"
 #include "threading/Algorithm.h"
+#include "threading/Combinable.h"
+#include "threading/EpochReclamation.h"
+#include "threading/HazardPointers.h"
 #include "threading/SemaphoreSingleProcess.h"
 #include "threading/ThreadPool.h"
 
@@ -276,6 +283,79 @@ BOOST_AUTO_TEST_CASE( ReadWriteSharedMutexTest )
         BOOST_CHECK( m.getEntry( i ).is_initialized() );
 }
 
+namespace
+{
+    // Operations per second (in millions) of nbThread threads doing n operations in total on random keys among keyCount, readPercent of them being reads
+    template < typename Read, typename Write >
+    double  mapThroughput( int nbThread, int n, int keyCount, int readPercent, Read read, Write write )
+    {
+        std::atomic< int > readyThreads( 0 );
+        std::atomic< bool > isStarted( false );
+        std::atomic< long long > found( 0 );
+
+        std::vector< std::thread > threads;
+        for ( auto t = 0; t < nbThread; ++t )
+            threads.emplace_back( [ &, t ]
+                {
+                    std::mt19937 generator( t );
+                    std::uniform_int_distribution< int > keys( 0, keyCount - 1 );
+                    std::uniform_int_distribution< int > percent( 0, 99 );
+                    long long localFound = 0;
+                    ++readyThreads;
+                    while ( ! isStarted )
+                        std::this_thread::yield();
+
+                    for ( auto i = n / nbThread; i != 0; --i )
+                    {
+                        const auto key = keys( generator );
+                        if ( percent( generator ) < readPercent )
+                            localFound += read( key );
+                        else
+                            write( key, i );
+                    }
+                    found += localFound;
+                } );
+
+        while ( readyThreads != nbThread )
+            std::this_thread::yield();
+
+        auto startTime = std::chrono::steady_clock::now();
+        isStarted = true;
+        for ( auto& thread : threads )
+            thread.join();
+        return n / std::chrono::duration< double >( std::chrono::steady_clock::now() - startTime ).count() / 1E6;
+    }
+}
+
+// containers::ConcurrentHashMap against MultipleReadSingleWrite (std::unordered_map behind a boost::shared_mutex), read-mostly and 50 / 50 mixes
+BOOST_AUTO_TEST_CASE( ConcurrentHashMapBenchmark )
+{
+    const auto n = 1'600'000;
+    const auto keyCount = 100'000;
+
+    std::cout << "readPercent;threads;sharedMutexMops;concurrentHashMapMops;" << std::endl;
+    for ( auto readPercent : { 95, 50 } )
+        for ( auto nbThread : { 1, 2, 4, 8, 16, 32 } )
+        {
+            MultipleReadSingleWrite sharedMutexMap;
+            containers::ConcurrentHashMap< int, int > concurrentMap( keyCount );
+            for ( auto key = 0; key < keyCount; key += 2 ) // half of the reads miss
+            {
+                sharedMutexMap.updateOrInsert( key, key );
+                concurrentMap.insert( key, key );
+            }
+
+            const auto sharedMutexMops = mapThroughput( nbThread, n, keyCount, readPercent,
+                                                        [ &sharedMutexMap ] ( int key ) { return sharedMutexMap.getEntry( key ).is_initialized(); },
+                                                        [ &sharedMutexMap ] ( int key, int value ) { sharedMutexMap.updateOrInsert( key, value ); } );
+            const auto concurrentMapMops = mapThroughput( nbThread, n, keyCount, readPercent,
+                                                          [ &concurrentMap ] ( int key ) { int value; return concurrentMap.find( key, value ); },
+                                                          [ &concurrentMap ] ( int key, int value ) { concurrentMap.insert_or_assign( key, value ); } );
+            std::cout << readPercent << ";" << nbThread << ";" << sharedMutexMops << ";" << concurrentMapMops << ";" << std::endl;
+            BOOST_CHECK( sharedMutexMops < concurrentMapMops );
+        }
+}
+
 BOOST_AUTO_TEST_CASE( ConditionVariableTest )
 {
     std::queue< int >           q;
@@ -430,4 +510,107 @@ BOOST_AUTO_TEST_CASE( ParallelFindTest )
     BOOST_CHECK( expectedResult == threading::parallel_find( std::begin( v ), std::end( v ), *expectedResult, 1 ) );
 }
 
+BOOST_AUTO_TEST_CASE( CombinableTest )
+{
+    threading::Combinable< int > combinable;
+
+    const auto nbThread = 8;
+    const auto nbIncrement = 1'000;
+    std::vector< std::thread > threads;
+    for ( auto i = 0; i < nbThread; ++i )
+        threads.emplace_back( [ &combinable, nbIncrement ]
+            {
+                bool exists = true;
+                combinable.local( exists );
+                BOOST_CHECK( ! exists );
+
+                // no write to any shared cache line
+                for ( auto j = 0; j < nbIncrement; ++j )
+                    ++combinable.local();
+            } );
+
+    for ( auto& thread : threads )
+        thread.join();
+
+    auto slotNumber = 0;
+    combinable.combine_each( [ &slotNumber, nbIncrement ] ( int value ) { BOOST_CHECK( value == nbIncrement ); ++slotNumber; } );
+    BOOST_CHECK( slotNumber == nbThread );
+    BOOST_CHECK( combinable.combine( std::plus< int >() ) == nbThread * nbIncrement );
+
+    combinable.clear();
+    BOOST_CHECK( combinable.combine( std::plus< int >() ) == 0 );
+}
+
+namespace
+{
+    struct Reclaimable
+    {
+        explicit Reclaimable( std::atomic< int >& destroyed ) : destroyed_( destroyed ) {}
+        ~Reclaimable() { ++destroyed_; }
+
+        std::atomic< int >& destroyed_;
+    };
+}
+
+BOOST_AUTO_TEST_CASE( HazardPointersTest )
+{
+    std::atomic< int > destroyed( 0 );
+    std::atomic< Reclaimable* > shared( new Reclaimable( destroyed ) );
+
+    {
+        threading::HazardPointers::Guard guard;
+        auto pointer = guard.protect( shared );
+
+        // unlinked and retired by another thread while still protected
+        std::thread( [ &shared ] { threading::HazardPointers::retire( shared.exchange( nullptr ) ); threading::HazardPointers::collect(); } ).join();
+        threading::HazardPointers::collect();
+        BOOST_CHECK( destroyed == 0 && pointer != nullptr );
+
+        guard.reset();
+        threading::HazardPointers::collect(); // the retired object of the exited thread is adopted
+        BOOST_CHECK( destroyed == 1 );
+    }
+
+    // every retired object is eventually reclaimed, without waiting for an explicit collect
+    for ( auto i = 0; i < 10'000; ++i )
+        threading::HazardPointers::retire( new Reclaimable( destroyed ) );
+    BOOST_CHECK( destroyed > 1 );
+    threading::HazardPointers::collect();
+    BOOST_CHECK( destroyed == 10'001 );
+}
+
+BOOST_AUTO_TEST_CASE( EpochReclamationTest )
+{
+    std::atomic< int > destroyed( 0 );
+
+    {
+        threading::EpochReclamation::Guard guard; // pinned, the epoch cannot advance twice
+        threading::EpochReclamation::retire( new Reclaimable( destroyed ) );
+        for ( auto i = 0; i < 3; ++i )
+            threading::EpochReclamation::collect();
+        BOOST_CHECK( destroyed == 0 );
+    }
+
+    for ( auto i = 0; i < 3; ++i )
+        threading::EpochReclamation::collect();
+    BOOST_CHECK( destroyed == 1 );
+
+    // a thread pinned forever blocks the reclamation of every thread
+    std::atomic< bool > isPinned( false ), stop( false );
+    std::thread pinned( [ & ] { threading::EpochReclamation::Guard guard; isPinned = true; while ( ! stop ) std::this_thread::yield(); } );
+    while ( ! isPinned )
+        std::this_thread::yield();
+
+    for ( auto i = 0; i < 1'000; ++i )
+        threading::EpochReclamation::retire( new Reclaimable( destroyed ) );
+    threading::EpochReclamation::collect();
+    BOOST_CHECK( destroyed == 1 && threading::EpochReclamation::pendingCount() >= 1'000 );
+
+    stop = true;
+    pinned.join();
+    for ( auto i = 0; i < 3; ++i )
+        threading::EpochReclamation::collect();
+    BOOST_CHECK( destroyed == 1'001 );
+}
+
 BOOST_AUTO_TEST_SUITE_END() // ThreadingTestSuite
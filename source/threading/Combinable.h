@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __THREADING_COMBINABLE_H__
+#define __THREADING_COMBINABLE_H__
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "tools/CacheInformation.h"
+
+namespace threading
+{
+    // Per-thread accumulator (similar to ppl::combinable / tbb::enumerable_thread_specific)
+    // - each thread lazily creates its own slot on the first call to local(), further calls only read shared memory
+    // - slots are aligned and padded to a cache line, so concurrent updates from different threads never invalidate each other (no false sharing)
+    // - the result is computed once all the threads are done, with combine() / combine_each()
+    // Slots are pushed in a lock-free list (one list per bucket, threads are hashed on their id), which is only walked by local() until the slot of the thread is found
+    template < typename T >
+    class Combinable
+    {
+    public:
+        Combinable()
+            : Combinable( [] { return T(); } )
+        {
+            // NOTHING
+        }
+
+        template < typename F >
+        explicit Combinable( F&& initializer )
+            : initializer_( std::forward< F >( initializer ) )
+        {
+            for ( auto& bucket : buckets_ )
+                bucket.store( nullptr, std::memory_order_relaxed );
+        }
+
+        Combinable( const Combinable& ) = delete;
+        Combinable& operator=( const Combinable& ) = delete;
+
+        ~Combinable()
+        {
+            clear();
+        }
+
+        T&      local()
+        {
+            bool exists;
+            return local( exists );
+        }
+
+        T&      local( bool& exists )
+        {
+            const auto id = std::this_thread::get_id();
+            auto& bucket = buckets_[ std::hash< std::thread::id >()( id ) % BucketNumber ];
+
+            auto head = bucket.load( std::memory_order_acquire );
+            for ( auto slot = head; slot != nullptr; slot = slot->next )
+                if ( slot->owner == id )
+                {
+                    exists = true;
+                    return slot->value;
+                }
+
+            // Only the current thread can insert a slot with this id, other threads can only push on the same bucket
+            auto slot = new Slot( initializer_(), id );
+            slot->next = head;
+            while ( ! bucket.compare_exchange_weak( slot->next, slot, std::memory_order_release, std::memory_order_relaxed ) )
+                ;
+
+            exists = false;
+            return slot->value;
+        }
+
+        // Must not be called concurrently with local()
+        template < typename F >
+        T       combine( F&& f ) const
+        {
+            bool isFirst = true;
+            T result = T();
+            combine_each( [ & ] ( const T& value )
+            {
+                result = isFirst ? value : f( result, value );
+                isFirst = false;
+            } );
+            return isFirst ? initializer_() : result;
+        }
+
+        // Must not be called concurrently with local()
+        template < typename F >
+        void    combine_each( F&& f ) const
+        {
+            for ( const auto& bucket : buckets_ )
+                for ( auto slot = bucket.load( std::memory_order_acquire ); slot != nullptr; slot = slot->next )
+                    f( static_cast< const T& >( slot->value ) );
+        }
+
+        // Must not be called concurrently with local()
+        void    clear()
+        {
+            for ( auto& bucket : buckets_ )
+            {
+                auto slot = bucket.exchange( nullptr, std::memory_order_acquire );
+                while ( slot != nullptr )
+                {
+                    auto next = slot->next;
+                    delete slot;
+                    slot = next;
+                }
+            }
+        }
+
+    private:
+        // alignas also pad the structure (sizeof is a multiple of the alignment)
+        struct alignas( tools::CacheLineSize ) Slot
+        {
+            Slot( T&& v, std::thread::id id )
+                : value( std::move( v ) )
+                , owner( id )
+                , next( nullptr )
+            {
+                // NOTHING
+            }
+
+            T                   value;
+            std::thread::id     owner;
+            Slot*               next;
+        };
+
+        static constexpr const std::size_t  BucketNumber = 64;
+
+        std::array< std::atomic< Slot* >, BucketNumber >    buckets_;
+        std::function< T() >                                initializer_;
+    };
+}
+
+#endif /* ! __THREADING_COMBINABLE_H__ */
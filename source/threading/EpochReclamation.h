@@ -0,0 +1,208 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __THREADING_EPOCHRECLAMATION_H__
+#define __THREADING_EPOCHRECLAMATION_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "threading/Reclamation.h"
+#include "tools/CacheInformation.h"
+
+namespace threading
+{
+    // Epoch based safe memory reclamation (Keir Fraser), see Reclamation.h for the usage
+    // - a Guard pins the thread in the current global epoch for the whole operation, reading a pointer is then a plain acquire load
+    // - the global epoch can only advance when every pinned thread has observed it, so an object retired in epoch e is unreachable by any guard once the epoch reaches e + 2
+    // - cheaper than hazard pointers per read (one fence per operation instead of one per pointer), but a thread preempted while pinned stops all the reclamation:
+    //   the number of objects waiting to be reclaimed is unbounded
+    class EpochReclamation
+    {
+    public:
+        // Guards can be nested, the thread stays pinned until the outermost one is destroyed
+        class Guard
+        {
+        public:
+            Guard()
+            {
+                threadState().pin();
+            }
+
+            Guard( const Guard& ) = delete;
+            Guard& operator=( const Guard& ) = delete;
+
+            ~Guard()
+            {
+                threadState().unpin();
+            }
+
+            template < typename P >
+            P*      protect( const std::atomic< P* >& source )
+            {
+                return source.load( std::memory_order_acquire );
+            }
+
+            // Same interface as HazardPointers::Guard, the thread stays pinned
+            void    reset()
+            {
+                // NOTHING
+            }
+        };
+
+        // pointer must be unreachable from the shared structure (new guards cannot protect it)
+        template < typename T >
+        static void     retire( T* pointer )
+        {
+            retire( pointer, &details::deleteRetired< T > );
+        }
+
+        static void     retire( void* pointer, void ( *deleter )( void* ) )
+        {
+            auto& state = threadState();
+            state.retired.push_back( details::Retired{ pointer, deleter, domain().epoch.load( std::memory_order_acquire ) } );
+            domain().pending.fetch_add( 1, std::memory_order_relaxed );
+
+            if ( state.retired.size() >= state.nextCollect )
+                state.collect();
+        }
+
+        // Try to advance the global epoch, then reclaim what can be reclaimed among the objects retired by the current thread
+        static void     collect()
+        {
+            threadState().collect();
+        }
+
+        // Number of objects retired but not yet reclaimed (all threads)
+        static std::size_t  pendingCount()
+        {
+            return domain().pending.load( std::memory_order_relaxed );
+        }
+
+    private:
+        static constexpr const std::size_t  CollectThreshold = 64;
+
+        struct alignas( tools::CacheLineSize ) Record
+        {
+            Record()
+                : state( 0 )
+                , active( false )
+                , next( nullptr )
+            {
+                // NOTHING
+            }
+
+            std::atomic< std::uint64_t >    state; // ( epoch << 1 ) | 1 while pinned, 0 otherwise
+            std::atomic< bool >             active;
+            Record*                         next;
+        };
+
+        struct Domain
+        {
+            Domain()
+                : epoch( 0 )
+                , pending( 0 )
+            {
+                // NOTHING
+            }
+
+            alignas( tools::CacheLineSize ) std::atomic< std::uint64_t >     epoch;
+            std::atomic< std::size_t >                                        pending;
+            details::RecordList< Record >                                     records;
+            details::Orphans                                                  orphans;
+        };
+
+        struct ThreadState
+        {
+            ThreadState()
+                : record( domain().records.acquire() )
+                , nesting( 0 )
+                , nextCollect( CollectThreshold )
+            {
+                // NOTHING
+            }
+
+            ~ThreadState()
+            {
+                collect();
+                domain().orphans.push( retired );
+                domain().records.release( record );
+            }
+
+            void    pin()
+            {
+                if ( nesting++ != 0 )
+                    return;
+
+                // release: the accesses of the previous critical section happen before a collector observing the new pin
+                record->state.store( ( domain().epoch.load( std::memory_order_relaxed ) << 1 ) | 1, std::memory_order_release );
+                std::atomic_thread_fence( std::memory_order_seq_cst ); // the pin is visible before any pointer is read
+            }
+
+            void    unpin()
+            {
+                if ( --nesting == 0 )
+                    record->state.store( 0, std::memory_order_release );
+            }
+
+            void    collect()
+            {
+                auto& d = domain();
+                d.orphans.adopt( retired );
+                if ( retired.empty() )
+                    return;
+
+                tryAdvance();
+                const auto epoch = d.epoch.load( std::memory_order_acquire );
+                auto pendingEnd = std::partition( retired.begin(), retired.end(), [ epoch ] ( const details::Retired& r ) { return r.epoch + 2 > epoch; } );
+                for ( auto it = pendingEnd; it != retired.end(); ++it )
+                    it->reclaim();
+                d.pending.fetch_sub( std::distance( pendingEnd, retired.end() ), std::memory_order_relaxed );
+                retired.erase( pendingEnd, retired.end() );
+
+                // objects still pending are only checked again once as many have been retired (amortized O(1) per retire while a thread blocks the epoch)
+                nextCollect = std::max( CollectThreshold, 2 * retired.size() );
+            }
+
+            static void     tryAdvance()
+            {
+                auto& d = domain();
+                std::atomic_thread_fence( std::memory_order_seq_cst );
+
+                auto epoch = d.epoch.load( std::memory_order_relaxed );
+                auto canAdvance = true;
+                d.records.forEach( [ epoch, &canAdvance ] ( const Record& r )
+                {
+                    const auto state = r.state.load( std::memory_order_acquire ); // synchronizes with unpin / pin
+                    if ( ( state & 1 ) != 0 && ( state >> 1 ) != epoch )
+                        canAdvance = false;
+                } );
+
+                if ( canAdvance )
+                    d.epoch.compare_exchange_strong( epoch, epoch + 1, std::memory_order_acq_rel );
+            }
+
+            Record*                         record;
+            std::size_t                     nesting;
+            std::size_t                     nextCollect;
+            std::vector< details::Retired > retired;
+        };
+
+        static Domain&      domain()
+        {
+            static Domain d;
+            return d;
+        }
+
+        static ThreadState& threadState()
+        {
+            static thread_local ThreadState state;
+            return state;
+        }
+    };
+}
+
+#endif /* ! __THREADING_EPOCHRECLAMATION_H__ */
@@ -0,0 +1,141 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __THREADING_EVENTCOUNT_H__
+#define __THREADING_EVENTCOUNT_H__
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+    #include <windows.h>
+    #pragma comment( lib, "Synchronization.lib" )
+#elif defined(__linux__)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include "tools/CacheInformation.h"
+
+namespace threading
+{
+    namespace details
+    {
+        // Sleep while *address == expected (spurious wake-ups allowed)
+        inline void     futexWait( std::atomic< std::uint32_t >* address, std::uint32_t expected )
+        {
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+            WaitOnAddress( address, &expected, sizeof( expected ), INFINITE );
+#elif defined(__linux__)
+            syscall( SYS_futex, reinterpret_cast< std::uint32_t* >( address ), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0 );
+#else
+            if ( address->load( std::memory_order_acquire ) == expected )
+                std::this_thread::yield();
+#endif
+        }
+
+        inline void     futexWake( std::atomic< std::uint32_t >* address, bool all )
+        {
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+            if ( all )
+                WakeByAddressAll( address );
+            else
+                WakeByAddressSingle( address );
+#elif defined(__linux__)
+            syscall( SYS_futex, reinterpret_cast< std::uint32_t* >( address ), FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr, nullptr, 0 );
+#else
+            static_cast< void >( address );
+            static_cast< void >( all );
+#endif
+        }
+    }
+
+    // Eventcount: blocking layer on top of a lock-free container (the condition variable of the lock-free world, without the mutex)
+    // Consumer side:
+    //     auto key = ec.prepareWait();     // register as waiter
+    //     if ( tryPop() ) ec.cancelWait(); // re-check the condition, no syscall if data is already there
+    //     else ec.wait( key );             // sleep until a notify happened after prepareWait
+    // Producer side: push then notify(), which only costs a fence and a read of waiters_ while nobody is waiting (no write to a shared cache line, no syscall)
+    // The fences pair a producer publishing then reading waiters_ with a consumer registering in waiters_ then re-checking the container, one of them sees the other
+    class EventCount
+    {
+    public:
+        class Key
+        {
+            friend class EventCount;
+            explicit Key( std::uint32_t epoch ) : epoch_( epoch ) {}
+            std::uint32_t   epoch_;
+        };
+
+        EventCount()
+            : epoch_( 0 )
+            , waiters_( 0 )
+        {
+            // NOTHING
+        }
+
+        EventCount( const EventCount& ) = delete;
+        EventCount& operator=( const EventCount& ) = delete;
+
+        void    notify()     { doNotify( false ); }
+        void    notifyAll()  { doNotify( true ); }
+
+        Key     prepareWait()
+        {
+            waiters_.fetch_add( 1, std::memory_order_seq_cst );
+            return Key( epoch_.load( std::memory_order_seq_cst ) );
+        }
+
+        void    cancelWait()
+        {
+            waiters_.fetch_sub( 1, std::memory_order_seq_cst );
+        }
+
+        void    wait( Key key )
+        {
+            while ( epoch_.load( std::memory_order_acquire ) == key.epoch_ )
+                details::futexWait( &epoch_, key.epoch_ );
+            waiters_.fetch_sub( 1, std::memory_order_seq_cst );
+        }
+
+        // Call f (a try operation returning something convertible to bool, e.g. a shared_ptr, a pointer or a bool) until it succeeds, sleep in between
+        template < typename F >
+        auto    await( F&& f ) -> decltype( f() )
+        {
+            for ( ;; )
+            {
+                if ( auto result = f() )
+                    return result;
+
+                auto key = prepareWait();
+                if ( auto result = f() )
+                {
+                    cancelWait();
+                    return result;
+                }
+                wait( key );
+            }
+        }
+
+    private:
+        void    doNotify( bool all )
+        {
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            if ( waiters_.load( std::memory_order_relaxed ) == 0 )
+                return;
+
+            epoch_.fetch_add( 1, std::memory_order_release );
+            details::futexWake( &epoch_, all );
+        }
+
+    private:
+        alignas( tools::CacheLineSize ) std::atomic< std::uint32_t >     epoch_; // futex word
+        std::atomic< std::uint32_t >                                      waiters_;
+    };
+}
+
+#endif /* ! __THREADING_EVENTCOUNT_H__ */
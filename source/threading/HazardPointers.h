@@ -0,0 +1,203 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __THREADING_HAZARDPOINTERS_H__
+#define __THREADING_HAZARDPOINTERS_H__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#include "threading/Reclamation.h"
+#include "tools/CacheInformation.h"
+
+namespace threading
+{
+    // Hazard pointers (Maged Michael) safe memory reclamation, see Reclamation.h for the usage
+    // - each thread owns SlotsPerThread hazard slots, a Guard publishes the pointer it reads in one of them and validates that the source did not change meanwhile
+    // - a retired object is only reclaimed if no slot references it, the check is done once the thread has retired enough objects (amortized O(1) per retire)
+    // - the number of objects waiting to be reclaimed is bounded (a few per hazard slot), even if a thread is preempted in the middle of an operation
+    // Reading a pointer costs a seq_cst store (a full fence on x86) and a re-load of the source
+    class HazardPointers
+    {
+    public:
+        static constexpr const std::size_t  SlotsPerThread = 4;
+
+        // Own a hazard slot of the current thread, guards must be destroyed in the reverse order of their construction (i.e. scoped)
+        class Guard
+        {
+        public:
+            Guard()
+                : slot_( threadState().acquireSlot() )
+            {
+                // NOTHING
+            }
+
+            Guard( const Guard& ) = delete;
+            Guard& operator=( const Guard& ) = delete;
+
+            ~Guard()
+            {
+                reset();
+                threadState().releaseSlot();
+            }
+
+            // The returned pointer cannot be reclaimed until the guard protects another pointer, is reset or destroyed
+            template < typename P >
+            P*      protect( const std::atomic< P* >& source )
+            {
+                auto pointer = source.load( std::memory_order_relaxed );
+                for ( ;; )
+                {
+                    slot_->store( pointer, std::memory_order_seq_cst );
+                    auto current = source.load( std::memory_order_seq_cst ); // still reachable after being published: a scan will see it
+                    if ( current == pointer )
+                        return pointer;
+                    pointer = current;
+                }
+            }
+
+            void    reset()
+            {
+                slot_->store( nullptr, std::memory_order_release );
+            }
+
+        private:
+            std::atomic< const void* >*     slot_;
+        };
+
+        // pointer must be unreachable from the shared structure (new guards cannot protect it)
+        template < typename T >
+        static void     retire( T* pointer )
+        {
+            retire( pointer, &details::deleteRetired< T > );
+        }
+
+        static void     retire( void* pointer, void ( *deleter )( void* ) )
+        {
+            auto& state = threadState();
+            state.retired.push_back( details::Retired{ pointer, deleter, 0 } );
+            domain().pending.fetch_add( 1, std::memory_order_relaxed );
+
+            if ( state.retired.size() >= std::max< std::size_t >( 64, 2 * SlotsPerThread * domain().records.size() ) )
+                state.scan();
+        }
+
+        // Reclaim what can be reclaimed among the objects retired by the current thread
+        static void     collect()
+        {
+            threadState().scan();
+        }
+
+        // Number of objects retired but not yet reclaimed (all threads)
+        static std::size_t  pendingCount()
+        {
+            return domain().pending.load( std::memory_order_relaxed );
+        }
+
+    private:
+        struct alignas( tools::CacheLineSize ) Record
+        {
+            Record()
+                : active( false )
+                , next( nullptr )
+            {
+                for ( auto& hazard : hazards )
+                    hazard.store( nullptr, std::memory_order_relaxed );
+            }
+
+            std::array< std::atomic< const void* >, SlotsPerThread >    hazards;
+            std::atomic< bool >                                         active;
+            Record*                                                     next;
+        };
+
+        struct Domain
+        {
+            Domain()
+                : pending( 0 )
+            {
+                // NOTHING
+            }
+
+            details::RecordList< Record >   records;
+            details::Orphans                orphans;
+            std::atomic< std::size_t >      pending;
+        };
+
+        struct ThreadState
+        {
+            ThreadState()
+                : record( domain().records.acquire() )
+                , usedSlots( 0 )
+            {
+                // NOTHING
+            }
+
+            ~ThreadState()
+            {
+                scan();
+                domain().orphans.push( retired );
+                domain().records.release( record );
+            }
+
+            std::atomic< const void* >*     acquireSlot()
+            {
+                assert( usedSlots < SlotsPerThread && "too many hazard pointer guards in the same thread" );
+                return &record->hazards[ usedSlots++ ];
+            }
+
+            void    releaseSlot()
+            {
+                --usedSlots;
+            }
+
+            void    scan()
+            {
+                auto& d = domain();
+                d.orphans.adopt( retired );
+                if ( retired.empty() )
+                    return;
+
+                // the objects were unlinked before being retired, order it with the read of the hazards
+                std::atomic_thread_fence( std::memory_order_seq_cst );
+
+                hazards.clear();
+                d.records.forEach( [ this ] ( const Record& r )
+                {
+                    for ( const auto& hazard : r.hazards )
+                        if ( auto pointer = hazard.load( std::memory_order_seq_cst ) )
+                            hazards.push_back( pointer );
+                } );
+                std::sort( hazards.begin(), hazards.end() );
+
+                auto protectedEnd = std::partition( retired.begin(), retired.end(), [ this ] ( const details::Retired& r ) { return std::binary_search( hazards.begin(), hazards.end(), r.pointer ); } );
+                for ( auto it = protectedEnd; it != retired.end(); ++it )
+                    it->reclaim();
+                d.pending.fetch_sub( std::distance( protectedEnd, retired.end() ), std::memory_order_relaxed );
+                retired.erase( protectedEnd, retired.end() );
+            }
+
+            Record*                         record;
+            std::size_t                     usedSlots;
+            std::vector< details::Retired > retired;
+            std::vector< const void* >      hazards; // scan buffer
+        };
+
+        static Domain&      domain()
+        {
+            static Domain d;
+            return d;
+        }
+
+        static ThreadState& threadState()
+        {
+            static thread_local ThreadState state;
+            return state;
+        }
+    };
+}
+
+#endif /* ! __THREADING_HAZARDPOINTERS_H__ */
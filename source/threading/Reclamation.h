@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#ifndef __THREADING_RECLAMATION_H__
+#define __THREADING_RECLAMATION_H__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Building blocks shared by the safe memory reclamation schemes (HazardPointers.h, EpochReclamation.h)
+// A reclamation scheme is used by a lock-free container as:
+//     typename Reclamation::Guard guard;     // RAII, protect the nodes read through guard.protect( atomicPointer ) from being reclaimed
+//     Reclamation::retire( unlinkedNode );   // delete the node once no guard can reference it anymore
+namespace threading
+{
+    namespace details
+    {
+        // Object waiting to be reclaimed, the deleter is type erased so a thread can retire nodes of any container
+        struct Retired
+        {
+            void    reclaim() const { deleter( pointer ); }
+
+            void*           pointer;
+            void            ( *deleter )( void* );
+            std::uint64_t   epoch; // only used by EpochReclamation
+        };
+
+        template < typename T >
+        void    deleteRetired( void* pointer )
+        {
+            delete static_cast< T* >( pointer );
+        }
+
+        // Lock-free list of per-thread records (Record must provide std::atomic< bool > active and Record* next)
+        // Records are never freed before the list, the record of an exited thread is reused by the next new thread
+        template < typename Record >
+        class RecordList
+        {
+        public:
+            RecordList()
+                : head_( nullptr )
+                , size_( 0 )
+            {
+                // NOTHING
+            }
+
+            RecordList( const RecordList& ) = delete;
+            RecordList& operator=( const RecordList& ) = delete;
+
+            ~RecordList()
+            {
+                auto record = head_.load( std::memory_order_acquire );
+                while ( record != nullptr )
+                {
+                    auto next = record->next;
+                    delete record;
+                    record = next;
+                }
+            }
+
+            Record*     acquire()
+            {
+                for ( auto record = head_.load( std::memory_order_acquire ); record != nullptr; record = record->next )
+                {
+                    auto expected = false;
+                    if ( ! record->active.load( std::memory_order_relaxed ) && record->active.compare_exchange_strong( expected, true, std::memory_order_acquire ) )
+                        return record;
+                }
+
+                auto record = new Record;
+                record->active.store( true, std::memory_order_relaxed );
+                record->next = head_.load( std::memory_order_relaxed );
+                while ( ! head_.compare_exchange_weak( record->next, record, std::memory_order_release, std::memory_order_relaxed ) )
+                    ;
+                size_.fetch_add( 1, std::memory_order_relaxed );
+                return record;
+            }
+
+            void        release( Record* record )
+            {
+                record->active.store( false, std::memory_order_release );
+            }
+
+            // Walk every record, including the inactive ones
+            template < typename F >
+            void        forEach( F&& f ) const
+            {
+                for ( auto record = head_.load( std::memory_order_acquire ); record != nullptr; record = record->next )
+                    f( *record );
+            }
+
+            std::size_t size() const { return size_.load( std::memory_order_relaxed ); }
+
+        private:
+            std::atomic< Record* >      head_;
+            std::atomic< std::size_t >  size_;
+        };
+
+        // Retired objects left by exited threads, adopted by the next thread doing a collection
+        class Orphans
+        {
+        public:
+            Orphans()
+                : hasOrphans_( false )
+            {
+                // NOTHING
+            }
+
+            // Every thread is done at this point
+            ~Orphans()
+            {
+                for ( const auto& retired : orphans_ )
+                    retired.reclaim();
+            }
+
+            void    push( std::vector< Retired >& retired )
+            {
+                if ( retired.empty() )
+                    return;
+
+                std::lock_guard< std::mutex > lock( mutex_ );
+                orphans_.insert( orphans_.end(), retired.begin(), retired.end() );
+                hasOrphans_.store( true, std::memory_order_release );
+                retired.clear();
+            }
+
+            void    adopt( std::vector< Retired >& retired )
+            {
+                if ( ! hasOrphans_.load( std::memory_order_acquire ) )
+                    return;
+
+                std::lock_guard< std::mutex > lock( mutex_ );
+                retired.insert( retired.end(), orphans_.begin(), orphans_.end() );
+                orphans_.clear();
+                hasOrphans_.store( false, std::memory_order_relaxed );
+            }
+
+        private:
+            std::atomic< bool >     hasOrphans_;
+            std::mutex              mutex_;
+            std::vector< Retired >  orphans_;
+        };
+    }
+}
+
+#endif /* ! __THREADING_RECLAMATION_H__ */
@@ -24,6 +24,8 @@ namespace threading
         template < typename F, typename... Args >
         auto enqueue( F&& f, Args&&... args ) -> std::future< std::result_of_t< F( Args... ) > >;
 
+        std::size_t size() const { return workers_.size(); }
+
     private:
         // need to keep track of threads so we can join them
         std::vector< std::thread >          workers_;
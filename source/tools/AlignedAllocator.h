@@ -0,0 +1,54 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#include "CacheInformation.h"
+
+namespace tools
+{
+    // std allocator whose buffers start on an Alignment boundary (a cache line by default)
+    // e.g. a vector scanned with aligned SIMD loads, or whose first element must not share a cache line with another object
+    template < typename T, std::size_t Alignment = CacheLineSize >
+    class AlignedAllocator
+    {
+        static_assert( Alignment >= alignof( T ) && ( Alignment & ( Alignment - 1 ) ) == 0, "Invalid alignment" );
+
+    public:
+        using value_type = T;
+
+        template < typename U >
+        struct rebind
+        {
+            using other = AlignedAllocator< U, Alignment >;
+        };
+
+        AlignedAllocator() = default;
+
+        template < typename U >
+        AlignedAllocator( const AlignedAllocator< U, Alignment >& )
+        {
+            // NOTHING
+        }
+
+        T*      allocate( std::size_t n )
+        {
+            return static_cast< T* >( ::operator new( n * sizeof( T ), std::align_val_t( Alignment ) ) );
+        }
+
+        void    deallocate( T* p, std::size_t )
+        {
+            ::operator delete( p, std::align_val_t( Alignment ) );
+        }
+
+        template < typename U >
+        bool    operator==( const AlignedAllocator< U, Alignment >& ) const { return true; }
+
+        template < typename U >
+        bool    operator!=( const AlignedAllocator< U, Alignment >& ) const { return false; }
+    };
+}
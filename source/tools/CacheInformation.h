@@ -4,12 +4,21 @@
 //--------------------------------------------------------------------------------
 #pragma once
 
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+#include "generic/Typetraits.h"
+
 namespace tools
 {
-    constexpr auto operator""   _KB( size_t s ) { return s * 1024; }
-    constexpr auto operator""   _MB( size_t s ) { return s * 1024 * 1000; }
+    constexpr auto operator""   _KB( unsigned long long s ) { return s * 1024; }
+    constexpr auto operator""   _MB( unsigned long long s ) { return s * 1024 * 1000; }
+
+    // Size of the coherence unit, data written by different threads should not share one (see CacheTestSuite FalseSharing*Benchmark)
+    static constexpr const size_t CacheLineSize = 64;
 
-    // Max number of segment in L1 = 32KB / 64 = 512
+    // Max number of segment in L1 = 32KB / CacheLineSize = 512
     enum class CacheSize
     {
         L1 = 32_KB,
@@ -0,0 +1,60 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#include "CacheMissCounter.h"
+
+#if defined(__linux__)
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+using namespace tools;
+
+CacheMissCounter::CacheMissCounter()
+    : fd_( -1 )
+{
+#if defined(__linux__)
+    perf_event_attr attr;
+    std::memset( &attr, 0, sizeof( attr ) );
+    attr.size = sizeof( attr );
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1; // threads created from now on
+
+    // this process, any cpu
+    fd_ = static_cast< int >( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+#endif
+}
+
+CacheMissCounter::~CacheMissCounter()
+{
+#if defined(__linux__)
+    if ( fd_ != -1 )
+        close( fd_ );
+#endif
+}
+
+void    CacheMissCounter::reset()
+{
+#if defined(__linux__)
+    if ( fd_ != -1 )
+        ioctl( fd_, PERF_EVENT_IOC_RESET, 0 );
+#endif
+}
+
+// The counts of the inherited threads are only added once they exited (join them before reading)
+std::uint64_t   CacheMissCounter::read() const
+{
+    std::uint64_t result = 0;
+#if defined(__linux__)
+    if ( fd_ != -1 && ::read( fd_, &result, sizeof( result ) ) != sizeof( result ) )
+        result = 0;
+#endif
+    return result;
+}
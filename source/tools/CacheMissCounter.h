@@ -0,0 +1,31 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+
+namespace tools
+{
+    // Hardware cache misses (last level cache) of the process, counted by the kernel (perf_event_open, Linux only)
+    // The counter is inherited by the threads created after the construction: create it before spawning the workers
+    // isAvailable() is false on other platforms, or if the kernel refuses (e.g. perf_event_paranoid, virtual machine without PMU), read() then returns 0
+    class CacheMissCounter
+    {
+    public:
+        CacheMissCounter();
+        ~CacheMissCounter();
+
+        CacheMissCounter( const CacheMissCounter& ) = delete;
+        CacheMissCounter& operator=( const CacheMissCounter& ) = delete;
+
+        bool            isAvailable() const { return fd_ != -1; }
+
+        void            reset();
+        std::uint64_t   read() const;
+
+    private:
+        int     fd_;
+    };
+}
@@ -0,0 +1,65 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tools
+{
+    // Latency samples (in ns) of one thread, merged once the threads are done to compute the percentiles
+    // Only one operation every SamplingPeriod is timed, so the two clock reads do not dominate the cost of the cheap operations
+    class LatencyRecorder
+    {
+    public:
+        static constexpr const unsigned SamplingPeriod = 16;
+
+        explicit LatencyRecorder( std::size_t expectedSamples = 0 )
+            : counter_( 0 )
+        {
+            samples_.reserve( expectedSamples / SamplingPeriod + 1 );
+        }
+
+        // Call f (a try operation), timed if it is the turn of a sample, return what f returns
+        // Failed attempts (e.g. empty / full container) are not an operation, they are not recorded
+        template < typename F >
+        auto    record( F&& f ) -> decltype( f() )
+        {
+            if ( ++counter_ % SamplingPeriod != 0 )
+                return f();
+
+            auto start = std::chrono::steady_clock::now();
+            auto result = f();
+            if ( result )
+                samples_.push_back( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start ).count() );
+            return result;
+        }
+
+        void    merge( const LatencyRecorder& other )
+        {
+            samples_.insert( samples_.end(), other.samples_.begin(), other.samples_.end() );
+        }
+
+        // percentile in [0, 100], 0 if there is no sample
+        std::int64_t    percentile( double p )
+        {
+            if ( samples_.empty() )
+                return 0;
+
+            auto nth = samples_.begin() + static_cast< std::ptrdiff_t >( p / 100. * ( samples_.size() - 1 ) );
+            std::nth_element( samples_.begin(), nth, samples_.end() );
+            return *nth;
+        }
+
+        std::size_t     size() const { return samples_.size(); }
+
+    private:
+        unsigned                        counter_;
+        std::vector< std::int64_t >     samples_;
+    };
+}
@@ -0,0 +1,30 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#include "ThreadAffinity.h"
+
+#include <thread>
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+bool    tools::pinCurrentThread( unsigned core )
+{
+    auto hardwareThreads = std::thread::hardware_concurrency();
+    if ( hardwareThreads != 0 )
+        core %= hardwareThreads;
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+    return SetThreadAffinityMask( GetCurrentThread(), static_cast< DWORD_PTR >( 1 ) << core ) != 0;
+#else
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    CPU_SET( core, &cpuSet );
+    return pthread_setaffinity_np( pthread_self(), sizeof( cpuSet ), &cpuSet ) == 0;
+#endif
+}
@@ -0,0 +1,12 @@
+//--------------------------------------------------------------------------------
+// (C) Copyright 2014-2015 Stephane Molina, All rights reserved.
+// See https://github.com/Dllieu for updates, documentation, and revision history.
+//--------------------------------------------------------------------------------
+#pragma once
+
+namespace tools
+{
+    // Pin the calling thread on one core (wrapped around the number of hardware threads), return false if the OS refused
+    // Producer / consumer benchmarks are meaningless if the scheduler moves the threads around (or put both on the same core)
+    bool    pinCurrentThread( unsigned core );
+}